@@ -0,0 +1,84 @@
+#!/usr/bin/env python3
+"""Recommends a combo term per combo from the firmware's gap histograms.
+
+Build with COMBO_STATS_ENABLE=yes, type normally for a while, press
+COMBO_STATS on QMK_LAYER and save the `qmk console` output. The last dump in
+the log is used.
+
+For each combo, "fire" counts the gaps of rolls that fired it and "miss"
+those typed as a roll of its keys without firing. The recommended term is
+the shortest one that still catches all but --target of the intended
+combos, as a longer term delays every key of the combo. It is then checked
+against the rolls: if more than --target of them would fire the combo at
+that term, the combo conflicts with normal typing and is flagged.
+
+Usage:
+  combo_stats.py log [--combos combos.def] [--target 0.01]
+"""
+
+import argparse
+import os
+import re
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+
+def combo_names(path):
+    with open(path) as f:
+        return re.findall(r"^COMB\((\w+),", f.read(), re.MULTILINE)
+
+
+def last_dump(path):
+    bucket_ms, stats = None, {}
+    with open(path, errors="replace") as f:
+        for line in f:
+            match = re.search(r"combo_stats bucket_ms (\d+)", line)
+            if match:
+                bucket_ms, stats = int(match.group(1)), {}
+                continue
+            match = re.search(r"combo_stats (\d+) fire ([\d ]+) miss ([\d ]+)", line)
+            if match:
+                stats[int(match.group(1))] = ([int(n) for n in match.group(2).split()],
+                                              [int(n) for n in match.group(3).split()])
+    if bucket_ms is None:
+        sys.exit(f"no combo_stats dump in {path}")
+    return bucket_ms, stats
+
+
+def shortest_term(fire, target):
+    """Returns the bucket count covering all but `target` of the fires."""
+    total = sum(fire)
+    covered = 0
+    for bucket, count in enumerate(fire):
+        covered += count
+        if covered >= total * (1 - target):
+            return bucket + 1
+    return len(fire)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("log")
+    parser.add_argument("--combos", default=os.path.join(HERE, "combos.def"))
+    parser.add_argument("--target", type=float, default=0.01, help="acceptable missed combo and misfire rate")
+    args = parser.parse_args()
+
+    names = combo_names(args.combos)
+    bucket_ms, stats = last_dump(args.log)
+
+    print(f"{'combo':<16}{'fires':>7}{'rolls':>7}{'term':>7}{'misfire':>9}")
+    for index, (fire, miss) in sorted(stats.items()):
+        name = names[index] if index < len(names) else str(index)
+        fires, rolls = sum(fire), sum(miss)
+        if fires == 0:
+            print(f"{name:<16}{fires:>7}{rolls:>7}{'-':>7}{'-':>9}")
+            continue
+        buckets = shortest_term(fire, args.target)
+        misfire = sum(miss[:buckets]) / rolls if rolls else 0.0
+        flag = "  conflicts with rolls" if misfire > args.target else ""
+        print(f"{name:<16}{fires:>7}{rolls:>7}{buckets * bucket_ms:>7}{misfire:>9.1%}{flag}")
+
+
+if __name__ == "__main__":
+    main()
@@ -11,16 +11,23 @@
 #undef RGBLED_SPLIT
 #define RGBLIGHT_SPLIT {1, 1}
 #define SPLIT_LED_STATE_ENABLE
-
-#define MOUSEKEY_INTERVAL    16
-#define MOUSEKEY_MAX_SPEED   7
-#define MOUSEKEY_TIME_TO_MAX 60
+#define SPLIT_TRANSACTION_IDS_USER SPLIT_TIMESTAMPS_SYNC
 
 #define TAPPING_TERM 300
 #define TAPPING_TERM_PER_KEY
 #define PERMISSIVE_HOLD
 #define QUICK_TAP_TERM 0
 #define ACHORDION_STREAK
+#define ACHORDION_RELEASE_ORDER
 
 #define COMBO_TERM 30
 #define COMBO_TERM_PER_COMBO
+// Shortest term get_combo_term() gives while typing fast. At COMBO_TERM the
+// term never shortens, lower it to keep fast rolls from firing combos.
+#define COMBO_TERM_MIN 30
+
+// features/macro_recorder.c saves its macro there, length byte included.
+#define EECONFIG_USER_DATA_SIZE 201
+
+// QMK's default, spelled out so keymap.c can check the features fit in it.
+#define MAX_DEFERRED_EXECUTORS 8
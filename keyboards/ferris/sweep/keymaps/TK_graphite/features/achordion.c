@@ -38,9 +38,31 @@ static uint8_t eager_mods = 0;
 // Flag to determine whether another key is pressed within the timeout.
 static bool pressed_another_key_before_release = false;
 
+#ifdef ACHORDION_RELEASE_ORDER
+// Press of the other key, held back until a release tells tap from hold.
+static keyrecord_t buffered_record;
+static bool has_buffered_record = false;
+#endif
+
 #ifdef ACHORDION_STREAK
 // Timer for typing streak
 static uint16_t streak_timer = 0;
+
+// Streaks are judged by event time, not by when the event is processed, so
+// keys changed in the same scan or restamped with an earlier time all see
+// the streak as it was when they were pressed.
+static bool in_streak(const keyrecord_t* record) {
+  return streak_timer && !timer_expired(record->event.time, streak_timer);
+}
+
+static void extend_streak(uint16_t keycode, const keyrecord_t* record) {
+  const uint16_t deadline =
+      (record->event.time + achordion_streak_timeout(keycode)) | 1;
+  // An older event processed late must not cut the streak short.
+  if (!streak_timer || timer_expired(deadline, streak_timer)) {
+    streak_timer = deadline;
+  }
+}
 #else
 // When disabled, is_streak is never true
 #define is_streak false
@@ -72,15 +94,57 @@ static void recursively_process_record(keyrecord_t* record, uint8_t state) {
 
 // Clears eagerly-applied mods.
 static void clear_eager_mods(void) {
+  if (eager_mods & (MOD_MASK_ALT | MOD_MASK_GUI)) {
+    // Alt or GUI pressed and released alone opens a menu on most hosts.
+    tap_code(ACHORDION_MASK_KEYCODE);
+  }
   unregister_mods(eager_mods);
   eager_mods = 0;
 }
 
+#ifdef ACHORDION_RELEASE_ORDER
+// Plumbs the held back press of the other key, if any.
+static void plumb_buffered_record(void) {
+  if (has_buffered_record) {
+    dprintf("Achordion: Plumbing press held back for %u ms.\n",
+            timer_elapsed(buffered_record.event.time));
+    has_buffered_record = false;
+    recursively_process_record(&buffered_record, achordion_state);
+  }
+}
+#endif
+
 // Sends hold press event and settles the active tap-hold key as held.
 static void settle_as_hold(void) {
-  clear_eager_mods();
+  // Hand eager mods over to the hold without a report: the hold press
+  // registers them again, so the host sees no release and re-press.
+  del_mods(eager_mods);
+  eager_mods = 0;
   // Create hold press event.
   recursively_process_record(&tap_hold_record, STATE_HOLDING);
+  send_keyboard_report();  // Only sends if the hold press was consumed.
+}
+
+// Sends tap press and release events and settles the active tap-hold key as
+// tapped.
+static void settle_as_tap(void) {
+  clear_eager_mods();  // Clear in case eager mods were set.
+
+  dprintln("Achordion: Plumbing tap press.");
+  tap_hold_record.tap.count = 1;  // Revise event as a tap.
+  tap_hold_record.tap.interrupted = true;
+  // Plumb tap press event.
+  recursively_process_record(&tap_hold_record, STATE_TAPPING);
+
+  send_keyboard_report();
+#if TAP_CODE_DELAY > 0
+  wait_ms(TAP_CODE_DELAY);
+#endif  // TAP_CODE_DELAY > 0
+
+  dprintln("Achordion: Plumbing tap release.");
+  tap_hold_record.event.pressed = false;
+  // Plumb tap release event.
+  recursively_process_record(&tap_hold_record, STATE_TAPPING);
 }
 
 bool process_achordion(uint16_t keycode, keyrecord_t* record) {
@@ -120,7 +184,10 @@ bool process_achordion(uint16_t keycode, keyrecord_t* record) {
         tap_hold_record = *record;
         hold_timer = record->event.time + timeout;
 
-        if (is_mt) {  // Apply mods immediately if they are "eager."
+#ifdef ACHORDION_STREAK
+        const bool is_streak = in_streak(record);
+#endif
+        if (is_mt && !is_streak) {  // Apply mods immediately if they are "eager."
           uint8_t mod = mod_config(QK_MOD_TAP_GET_MODS(tap_hold_keycode));
           if (achordion_eager_mod(mod)) {
             eager_mods = ((mod & 0x10) == 0) ? mod : (mod << 4);
@@ -135,11 +202,36 @@ bool process_achordion(uint16_t keycode, keyrecord_t* record) {
     }
 
 #ifdef ACHORDION_STREAK
-    streak_timer = (timer_read() + achordion_streak_timeout(keycode)) | 1;
+    extend_streak(keycode, record);
 #endif
     return true;  // Otherwise, continue with default handling.
   }
 
+#ifdef ACHORDION_RELEASE_ORDER
+  if (has_buffered_record && !record->event.pressed) {
+    if (keycode == tap_hold_keycode) {
+      // Released before the other key: a roll, unless they overlapped long.
+      if (TIMER_DIFF_16(record->event.time, buffered_record.event.time) <
+          ACHORDION_RELEASE_OVERLAP) {
+        dprintln("Achordion: Key released first. Settling as tap.");
+        settle_as_tap();
+      } else {
+        dprintln("Achordion: Key released after overlap. Settling as hold.");
+        settle_as_hold();
+      }
+      plumb_buffered_record();
+      // Continue below to handle the release.
+    } else if (KEYEQ(record->event.key, buffered_record.event.key)) {
+      // The other key is released while the tap-hold key is still held.
+      dprintln("Achordion: Other key released first. Settling as hold.");
+      settle_as_hold();
+      plumb_buffered_record();
+      recursively_process_record(record, achordion_state);
+      return false;
+    }
+  }
+#endif
+
   if (keycode == tap_hold_keycode && !record->event.pressed) {
     // The active tap-hold key is being released.
     if (achordion_state == STATE_HOLDING) {
@@ -173,12 +265,23 @@ bool process_achordion(uint16_t keycode, keyrecord_t* record) {
 
   if (achordion_state == STATE_UNSETTLED && record->event.pressed) {
 #ifdef ACHORDION_STREAK
-    const bool is_streak = (streak_timer != 0);
-    streak_timer = (timer_read() + achordion_streak_timeout(keycode)) | 1;
+    const bool is_streak = in_streak(record);
+    extend_streak(keycode, record);
 #endif
 
     // Press event occurred on a key other than the active tap-hold key.
 
+#ifdef ACHORDION_RELEASE_ORDER
+    if (has_buffered_record) {
+      // A third key while the release order is pending, chording.
+      dprintln("Achordion: Third key pressed. Plumbing hold press.");
+      settle_as_hold();
+      plumb_buffered_record();
+      recursively_process_record(record, achordion_state);
+      return false;
+    }
+#endif
+
     // If the other key is *also* a tap-hold key and considered by QMK to be
     // held, then we settle the active key as held. This way, things like
     // chording multiple home row modifiers will work, but let's our logic
@@ -191,26 +294,20 @@ bool process_achordion(uint16_t keycode, keyrecord_t* record) {
     // in turn calls most handlers including `process_record_user()`.
     if (!is_streak && (!is_key_event || (is_tap_hold && record->tap.count == 0) ||
         achordion_chord(tap_hold_keycode, &tap_hold_record, keycode, record))) {
+#ifdef ACHORDION_RELEASE_ORDER
+      if (is_key_event && IS_BASIC_KEYCODE(keycode)) {
+        // Typed keys rolled over the tap-hold key look like chords on press.
+        // Hold back the press and settle on whichever key is released first.
+        dprintln("Achordion: Holding back press until a release.");
+        buffered_record = *record;
+        has_buffered_record = true;
+        return false;
+      }
+#endif
       dprintln("Achordion: Plumbing hold press.");
       settle_as_hold();
     } else {
-      clear_eager_mods();  // Clear in case eager mods were set.
-
-      dprintln("Achordion: Plumbing tap press.");
-      tap_hold_record.tap.count = 1;  // Revise event as a tap.
-      tap_hold_record.tap.interrupted = true;
-      // Plumb tap press event.
-      recursively_process_record(&tap_hold_record, STATE_TAPPING);
-
-      send_keyboard_report();
-#if TAP_CODE_DELAY > 0
-      wait_ms(TAP_CODE_DELAY);
-#endif  // TAP_CODE_DELAY > 0
-
-      dprintln("Achordion: Plumbing tap release.");
-      tap_hold_record.event.pressed = false;
-      // Plumb tap release event.
-      recursively_process_record(&tap_hold_record, STATE_TAPPING);
+      settle_as_tap();
     }
 
     recursively_process_record(record, achordion_state);  // Re-process event.
@@ -219,7 +316,7 @@ bool process_achordion(uint16_t keycode, keyrecord_t* record) {
 
 #ifdef ACHORDION_STREAK
   // update idle timer on regular keys event
-  streak_timer = (timer_read() + achordion_streak_timeout(keycode)) | 1;
+  extend_streak(keycode, record);
 #endif
   return true;
 }
@@ -229,10 +326,16 @@ void achordion_task(void) {
       timer_expired(timer_read(), hold_timer)) {
     dprintln("Achordion: Timeout. Plumbing hold press.");
     settle_as_hold();  // Timeout expired, settle the key as held.
+#ifdef ACHORDION_RELEASE_ORDER
+    plumb_buffered_record();
+#endif
   }
 
 #ifdef ACHORDION_STREAK
-  if (streak_timer && timer_expired(timer_read(), streak_timer)) {
+  // An expired streak is kept for a second, so an event stamped before it
+  // expired but processed after still sees it. It's cleared long before the
+  // 16-bit timer wraps around.
+  if (streak_timer && timer_expired(timer_read(), streak_timer + 1000)) {
     streak_timer = 0;  // Expired.
   }
 #endif
@@ -74,6 +74,25 @@
 uint16_t achordion_streak_timeout(uint16_t tap_hold_keycode);
 #endif
 
+/**
+ * Settle rolls by release order by defining ACHORDION_RELEASE_ORDER.
+ *
+ * When `achordion_chord()` returns true for a basic key, its press is held
+ * back instead of settling right away:
+ *
+ *  * If the other key is released first, the tap-hold key is held.
+ *  * If the tap-hold key is released first within ACHORDION_RELEASE_OVERLAP
+ *    ms of the other key's press, it was a roll and is tapped. After a longer
+ *    overlap it is held.
+ *  * A third key press or the timeout settles it as held.
+ *
+ *    #define ACHORDION_RELEASE_ORDER
+ *    #define ACHORDION_RELEASE_OVERLAP 80  // Default.
+ */
+#if defined(ACHORDION_RELEASE_ORDER) && !defined(ACHORDION_RELEASE_OVERLAP)
+#define ACHORDION_RELEASE_OVERLAP 80
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -162,6 +181,11 @@ uint16_t achordion_timeout(uint16_t tap_hold_keycode);
  *       return (mod & (MOD_LALT | MOD_LGUI)) == 0;
  *     }
  *
+ * When the key settles as tapped, eager Alt or GUI mods are masked by tapping
+ * `ACHORDION_MASK_KEYCODE` before they are released, so the host doesn't
+ * open a menu for a lone Alt or GUI press. Eager mods are not applied during
+ * a typing streak, where the key is most likely a tap.
+ *
  * @note `mod` should be compared with `MOD_` prefixed codes, not `KC_` codes,
  * described at <https://docs.qmk.fm/#/mod_tap>.
  *
@@ -170,6 +194,14 @@ uint16_t achordion_timeout(uint16_t tap_hold_keycode);
  */
 bool achordion_eager_mod(uint8_t mod);
 
+/**
+ * Keycode tapped to mask eager Alt and GUI mods before rolling them back. It
+ * should do nothing on the host, the default is F24.
+ */
+#ifndef ACHORDION_MASK_KEYCODE
+#define ACHORDION_MASK_KEYCODE KC_F24
+#endif
+
 /**
  * Returns true if the args come from keys on opposite hands.
  *
@@ -0,0 +1,138 @@
+#include "combo_stats.h"
+
+typedef struct
+{
+    uint16_t fire[COMBO_STATS_BUCKETS];
+    uint16_t miss[COMBO_STATS_BUCKETS];
+} combo_histogram_t;
+
+static combo_histogram_t histograms[COMBO_STATS_MAX_COMBOS];
+// Last press time of each key of each combo, 0 if not pressed since the last roll.
+static uint16_t press_times[COMBO_STATS_MAX_COMBOS][COMBO_STATS_MAX_KEYS];
+// Roll waiting to learn whether it fired its combo.
+static struct
+{
+    uint8_t bucket;
+    uint16_t time;
+    bool waiting;
+} pending[COMBO_STATS_MAX_COMBOS];
+
+// A combo fires at the latest when its term runs out, so it's a miss after that.
+#define COMBO_STATS_SETTLE 100
+
+static uint8_t tracked_combos(void)
+{
+    const uint16_t count = combo_count();
+    return count < COMBO_STATS_MAX_COMBOS ? count : COMBO_STATS_MAX_COMBOS;
+}
+
+static void count(uint16_t* counter)
+{
+    if(*counter < UINT16_MAX)
+    {
+        ++*counter;
+    }
+}
+
+static void settle_misses(uint16_t now)
+{
+    for(uint8_t i = 0; i < COMBO_STATS_MAX_COMBOS; ++i)
+    {
+        if(pending[i].waiting && TIMER_DIFF_16(now, pending[i].time) >= COMBO_STATS_SETTLE)
+        {
+            count(&histograms[i].miss[pending[i].bucket]);
+            pending[i].waiting = false;
+        }
+    }
+}
+
+void pre_process_combo_stats(uint16_t keycode, keyrecord_t* record)
+{
+    if(!record->event.pressed || !IS_KEYEVENT(record->event))
+    {
+        return;
+    }
+    // Event times are never 0, which marks keys not pressed.
+    const uint16_t now = record->event.time | 1;
+    settle_misses(now);
+
+    for(uint8_t i = 0; i < tracked_combos(); ++i)
+    {
+        const uint16_t* keys = combo_get(i)->keys;
+        uint16_t first       = now;
+        bool member          = false;
+        bool complete        = true;
+        for(uint8_t k = 0; k < COMBO_STATS_MAX_KEYS; ++k)
+        {
+            const uint16_t key = pgm_read_word(&keys[k]);
+            if(key == COMBO_END)
+            {
+                break;
+            }
+            if(key == keycode)
+            {
+                press_times[i][k] = now;
+                member            = true;
+            }
+            const uint16_t time = press_times[i][k];
+            if(time == 0 || TIMER_DIFF_16(now, time) >= COMBO_STATS_WINDOW)
+            {
+                complete = false;
+            }
+            else if(TIMER_DIFF_16(now, time) > TIMER_DIFF_16(now, first))
+            {
+                first = time;
+            }
+        }
+        if(!member || !complete)
+        {
+            continue;
+        }
+
+        memset(press_times[i], 0, sizeof(press_times[i]));
+        if(pending[i].waiting)
+        {
+            count(&histograms[i].miss[pending[i].bucket]);
+        }
+        pending[i].bucket  = TIMER_DIFF_16(now, first) / COMBO_STATS_BUCKET_MS;
+        pending[i].time    = now;
+        pending[i].waiting = true;
+    }
+}
+
+void process_combo_stats(uint16_t keycode, keyrecord_t* record)
+{
+    if(!record->event.pressed || !IS_COMBOEVENT(record->event))
+    {
+        return;
+    }
+    for(uint8_t i = 0; i < tracked_combos(); ++i)
+    {
+        if(pending[i].waiting && combo_get(i)->keycode == keycode)
+        {
+            count(&histograms[i].fire[pending[i].bucket]);
+            pending[i].waiting = false;
+            return;
+        }
+    }
+}
+
+void combo_stats_dump(void)
+{
+    settle_misses(timer_read());
+    uprintf("combo_stats bucket_ms %u\n", COMBO_STATS_BUCKET_MS);
+    for(uint8_t i = 0; i < tracked_combos(); ++i)
+    {
+        uprintf("combo_stats %u fire", i);
+        for(uint8_t b = 0; b < COMBO_STATS_BUCKETS; ++b)
+        {
+            uprintf(" %u", histograms[i].fire[b]);
+        }
+        uprintf(" miss");
+        for(uint8_t b = 0; b < COMBO_STATS_BUCKETS; ++b)
+        {
+            uprintf(" %u", histograms[i].miss[b]);
+        }
+        uprintf("\n");
+    }
+}
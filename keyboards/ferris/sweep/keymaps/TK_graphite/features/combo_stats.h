@@ -0,0 +1,45 @@
+#pragma once
+
+#include "quantum.h"
+
+/**
+ * Press-gap statistics per combo, to tune the combo terms.
+ *
+ * Every time all keys of a combo have been pressed within
+ * COMBO_STATS_WINDOW, the gap between the first and the last of them is
+ * counted in one of two histograms of that combo: "fire" if the combo
+ * fired, "miss" if the keys were typed as a roll instead. `combo_stats_dump()`
+ * prints the histograms to the console, one line per combo in the order of
+ * combos.def, for combo_stats.py to turn into term recommendations.
+ *
+ * Counts are kept in RAM and saturate, they are lost on reset.
+ */
+
+// Histogram buckets, COMBO_STATS_BUCKET_MS wide each.
+#ifndef COMBO_STATS_BUCKETS
+#define COMBO_STATS_BUCKETS 16
+#endif
+
+#ifndef COMBO_STATS_BUCKET_MS
+#define COMBO_STATS_BUCKET_MS 10
+#endif
+
+#define COMBO_STATS_WINDOW (COMBO_STATS_BUCKETS * COMBO_STATS_BUCKET_MS)
+
+// Combos and keys per combo tracked, extra ones are ignored.
+#ifndef COMBO_STATS_MAX_COMBOS
+#define COMBO_STATS_MAX_COMBOS 24
+#endif
+
+#ifndef COMBO_STATS_MAX_KEYS
+#define COMBO_STATS_MAX_KEYS 4
+#endif
+
+/** Call from `pre_process_record_user()`, before combos see the event. Never consumes it. */
+void pre_process_combo_stats(uint16_t keycode, keyrecord_t* record);
+
+/** Call from `process_record_user()`, to see the events of fired combos. Never consumes it. */
+void process_combo_stats(uint16_t keycode, keyrecord_t* record);
+
+/** Prints the histograms to the console. */
+void combo_stats_dump(void);
@@ -0,0 +1,252 @@
+#include "compose.h"
+
+#define LETTER(c) (1UL << ((c) - 'a'))
+
+// Dead key waiting for its accent key on the accent layer.
+static uint16_t pending_accent   = KC_NO;
+static uint32_t pending_time     = 0;
+// Dead key already sent literally, still owing the space that completes it.
+static uint16_t owed_accent      = KC_NO;
+static deferred_token owed_token = INVALID_DEFERRED_TOKEN;
+
+static bool is_dead_key(uint16_t keycode)
+{
+    switch(keycode)
+    {
+    case KC_QUOT:
+    case KC_GRV:
+    case KC_DQUO:
+    case KC_TILD:
+    case KC_CIRC:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Letters that combine with each dead key on US International.
+static uint32_t combining_letters(uint16_t dead_key)
+{
+    switch(dead_key)
+    {
+    case KC_QUOT:
+        return LETTER('a') | LETTER('c') | LETTER('e') | LETTER('i') | LETTER('o') | LETTER('u') | LETTER('y');
+    case KC_DQUO:
+        return LETTER('a') | LETTER('e') | LETTER('i') | LETTER('o') | LETTER('u') | LETTER('y');
+    case KC_TILD:
+        return LETTER('a') | LETTER('n') | LETTER('o');
+    default:
+        return LETTER('a') | LETTER('e') | LETTER('i') | LETTER('o') | LETTER('u');
+    }
+}
+
+// Returns true if `keycode` would combine with the dead key, or if it's unclear.
+static bool combines(uint16_t dead_key, uint16_t keycode)
+{
+    if(get_mods() & ~MOD_MASK_SHIFT)
+    {
+        return true;  // Shortcut, close the dead key first.
+    }
+    const uint8_t basic = IS_QK_MODS(keycode) ? QK_MODS_GET_BASIC_KEYCODE(keycode) : keycode;
+    switch(basic)
+    {
+    case KC_A ... KC_Z:
+        return combining_letters(dead_key) & (1UL << (basic - KC_A));
+    case KC_1 ... KC_0:
+    case KC_MINS ... KC_BSLS:
+    case KC_SCLN:
+    case KC_COMM ... KC_SLSH:
+        return false;
+    default:
+        return true;
+    }
+}
+
+// Taps the space that completes a literal dead key. Held mods, e.g. an
+// eager Ctrl, are lifted for it so it doesn't become a shortcut.
+static void tap_owed_space(void)
+{
+    const uint8_t mods         = get_mods();
+    const uint8_t oneshot_mods = get_oneshot_mods();
+    if(!(mods | oneshot_mods))
+    {
+        tap_code(KC_SPC);
+        return;
+    }
+    clear_mods();
+    del_oneshot_mods(oneshot_mods);
+    tap_code(KC_SPC);
+    set_mods(mods);
+    add_oneshot_mods(oneshot_mods);
+    send_keyboard_report();
+}
+
+static void settle_owed(void)
+{
+    owed_accent = KC_NO;
+    if(owed_token != INVALID_DEFERRED_TOKEN)
+    {
+        cancel_deferred_exec(owed_token);
+        owed_token = INVALID_DEFERRED_TOKEN;
+    }
+}
+
+static uint32_t owed_callback(uint32_t trigger_time, void* cb_arg)
+{
+    owed_token  = INVALID_DEFERRED_TOKEN;
+    owed_accent = KC_NO;
+    tap_owed_space();
+    return 0;
+}
+
+// Taps `keycode` with Shift lifted, dead keys must not be shifted.
+static void tap_unshifted(uint16_t keycode)
+{
+    const uint8_t mods = get_mods();
+    del_mods(MOD_MASK_SHIFT);
+    tap_code16(keycode);
+    set_mods(mods);
+}
+
+void compose_tap_dead_key(uint16_t dead_key)
+{
+    settle_owed();
+    tap_code16(dead_key);
+    owed_accent = dead_key;
+    owed_token  = defer_exec(COMPOSE_DEAD_KEY_TIMEOUT, owed_callback, NULL);
+}
+
+static void send_composed(uint16_t accent, uint16_t base)
+{
+    const uint16_t* output = NULL;
+    for(uint8_t i = 0; i < compose_table_count; ++i)
+    {
+        if(compose_table[i].accent == accent && compose_table[i].base == base)
+        {
+            output = compose_table[i].output;
+            break;
+        }
+    }
+
+    // Shift belongs to the letter only, one-shot Shift is used up by it.
+    const bool shifted = (get_mods() | get_oneshot_mods()) & MOD_MASK_SHIFT;
+    del_oneshot_mods(MOD_MASK_SHIFT);
+    if(output)
+    {
+        for(uint8_t i = 0; i < COMPOSE_MAX_OUTPUT && output[i] != KC_NO; ++i)
+        {
+            const bool last = i + 1 == COMPOSE_MAX_OUTPUT || output[i + 1] == KC_NO;
+            tap_unshifted(last && shifted ? LSFT(output[i]) : output[i]);
+        }
+    }
+    else
+    {
+        if(accent != KC_NO)
+        {
+            tap_unshifted(accent);
+        }
+        tap_unshifted(shifted ? LSFT(base) : base);
+    }
+}
+
+// Returns the 8-bit mods other than Shift that the press of `keycode` adds.
+static uint8_t shortcut_mods(uint16_t keycode, keyrecord_t* record)
+{
+    uint8_t mods = 0;
+    if(IS_MODIFIER_KEYCODE(keycode))
+    {
+        mods = MOD_BIT(keycode);
+    }
+    else if(IS_QK_ONE_SHOT_MOD(keycode) || (IS_QK_MOD_TAP(keycode) && record->tap.count == 0))
+    {
+        // 5-bit mods, only the sides differ so the low bits are enough.
+        mods = (IS_QK_ONE_SHOT_MOD(keycode) ? keycode : QK_MOD_TAP_GET_MODS(keycode)) & 0x0F;
+    }
+    return mods & ~MOD_MASK_SHIFT;
+}
+
+bool process_compose(uint16_t keycode, keyrecord_t* record)
+{
+    // A dead key left waiting is forgotten once the accent layer is left or
+    // after a while, so it can't combine with an unrelated key later.
+    if(pending_accent != KC_NO && (!compose_layer_user() || timer_elapsed32(pending_time) > COMPOSE_PENDING_TIMEOUT))
+    {
+        pending_accent = KC_NO;
+    }
+
+    if(is_dead_key(keycode))
+    {
+        if(record->event.pressed)
+        {
+            if(owed_accent != KC_NO)
+            {
+                settle_owed();
+                tap_owed_space();
+            }
+            if(compose_layer_user())
+            {
+                pending_accent = keycode;
+                pending_time   = timer_read32();
+            }
+            else
+            {
+                compose_tap_dead_key(keycode);
+            }
+        }
+        return false;
+    }
+
+    // Complete the dead key before a mod turns the space into a shortcut.
+    if(owed_accent != KC_NO && record->event.pressed && shortcut_mods(keycode, record))
+    {
+        settle_owed();
+        tap_owed_space();
+    }
+
+    const bool is_hold = (IS_QK_MOD_TAP(keycode) || IS_QK_LAYER_TAP(keycode)) && record->tap.count == 0;
+    if(!record->event.pressed || is_hold || IS_MODIFIER_KEYCODE(keycode) || IS_QK_ONE_SHOT_MOD(keycode))
+    {
+        return true;
+    }
+    if(IS_QK_MOD_TAP(keycode))
+    {
+        keycode = QK_MOD_TAP_GET_TAP_KEYCODE(keycode);
+    }
+    else if(IS_QK_LAYER_TAP(keycode))
+    {
+        keycode = QK_LAYER_TAP_GET_TAP_KEYCODE(keycode);
+    }
+
+    const uint16_t base = compose_base_user(keycode);
+    if(owed_accent != KC_NO)
+    {
+        const bool space = base != KC_NO || combines(owed_accent, keycode);
+        settle_owed();
+        if(space)
+        {
+            tap_owed_space();
+        }
+    }
+    if(base != KC_NO)
+    {
+        send_composed(pending_accent, base);
+        pending_accent = KC_NO;
+    }
+    else if(pending_accent != KC_NO)
+    {
+        // Not an accent key, let the host combine the dead key with it.
+        tap_unshifted(pending_accent);
+        pending_accent = KC_NO;
+    }
+    return true;
+}
+
+__attribute__((weak)) bool compose_layer_user(void)
+{
+    return false;
+}
+
+__attribute__((weak)) uint16_t compose_base_user(uint16_t keycode)
+{
+    return KC_NO;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "quantum.h"
+
+/**
+ * Accent composition for the US International dead keys (' ` " ~ ^).
+ *
+ * On the accent layer (see `compose_layer_user()`), a dead key is only
+ * remembered. The following accent key (see `compose_base_user()`) then sends
+ * the whole glyph in one go: the sequence from `compose_table` if the pair is
+ * listed there, e.g. a single AltGr chord, and otherwise the dead key followed
+ * by the base letter. A remembered dead key is dropped when the accent layer
+ * is left or after `COMPOSE_PENDING_TIMEOUT` ms.
+ *
+ * Everywhere else a dead key is meant literally. It is sent right away and the
+ * space that turns it into a plain character is only sent if the next key
+ * would otherwise combine with it, before Ctrl, Alt or GUI is pressed, or
+ * after `COMPOSE_DEAD_KEY_TIMEOUT` ms without another key. Mods still held
+ * then are lifted for the space. Requires `DEFERRED_EXEC_ENABLE = yes`.
+ */
+
+#ifndef COMPOSE_DEAD_KEY_TIMEOUT
+#define COMPOSE_DEAD_KEY_TIMEOUT 500
+#endif
+
+#ifndef COMPOSE_PENDING_TIMEOUT
+#define COMPOSE_PENDING_TIMEOUT 5000
+#endif
+
+#ifndef COMPOSE_MAX_OUTPUT
+#define COMPOSE_MAX_OUTPUT 2
+#endif
+
+// Deferred executors scheduled at most at the same time.
+#define COMPOSE_DEFERRED_EXECUTORS 1
+
+typedef struct
+{
+    uint16_t accent;
+    uint16_t base;
+    // Keys tapped for the glyph, padded with KC_NO.
+    uint16_t output[COMPOSE_MAX_OUTPUT];
+} compose_t;
+
+extern const compose_t compose_table[];
+extern const uint8_t compose_table_count;
+
+/**
+ * Handler, call from `process_record_user()` before other handlers so it sees
+ * every key. Returns false if the event was consumed. Accent keys are sent and
+ * then passed on, so the keymap can e.g. leave the accent layer.
+ */
+bool process_compose(uint16_t keycode, keyrecord_t* record);
+
+/** Taps `dead_key` as a literal character, e.g. from a macro. */
+void compose_tap_dead_key(uint16_t dead_key);
+
+/** Returns true while dead keys should wait for an accent key. */
+bool compose_layer_user(void);
+
+/** Returns the base letter of an accent key, or KC_NO for any other key. */
+uint16_t compose_base_user(uint16_t keycode);
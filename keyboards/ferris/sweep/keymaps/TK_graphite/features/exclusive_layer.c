@@ -0,0 +1,34 @@
+#include "exclusive_layer.h"
+
+static uint8_t active_layer = 0;
+static bool stacked         = false;
+
+layer_state_t exclusive_layer_state_set(layer_state_t state)
+{
+    stacked = (state & (state - 1)) != 0;
+    if(stacked)
+    {
+        // Momentary layer held on top, use the generic scan.
+        active_layer = get_highest_layer(state | default_layer_state);
+    }
+    else if(state != 0)
+    {
+        // Exactly one layer is on, its bit position is the active layer.
+        active_layer = __builtin_ctz(state);
+    }
+    else
+    {
+        active_layer = get_highest_layer(default_layer_state);
+    }
+    return state;
+}
+
+uint8_t exclusive_layer_get(void)
+{
+    return active_layer;
+}
+
+bool exclusive_layer_is_stacked(void)
+{
+    return stacked;
+}
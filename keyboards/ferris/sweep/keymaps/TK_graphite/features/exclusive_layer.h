@@ -0,0 +1,26 @@
+#pragma once
+
+#include "quantum.h"
+
+/**
+ * Tracks the active layer of a keymap that switches layers exclusively with
+ * `layer_move()`/`TO()`.
+ *
+ * While only one layer is on, its index is read straight off the single set
+ * bit and cached, so every lookup afterwards is a plain read. Momentary layers
+ * held on top (`MO`, `LT` holds) make the state "stacked", in which case the
+ * cache falls back to the generic highest-layer scan.
+ *
+ * Call from `layer_state_set_user()`:
+ *
+ *     layer_state_t layer_state_set_user(layer_state_t state) {
+ *         return exclusive_layer_state_set(state);
+ *     }
+ */
+layer_state_t exclusive_layer_state_set(layer_state_t state);
+
+/** Returns the index of the highest active layer. */
+uint8_t exclusive_layer_get(void);
+
+/** Returns true while a momentary layer is held on top of the exclusive one. */
+bool exclusive_layer_is_stacked(void);
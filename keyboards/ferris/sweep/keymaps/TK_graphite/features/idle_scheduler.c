@@ -0,0 +1,66 @@
+#include "idle_scheduler.h"
+
+static idle_stage_t stage = IDLE_ACTIVE;
+// Start of the last sleep, to bound how long a waking press waited.
+static uint16_t last_sleep = 0;
+static uint16_t wake_bound = 0;
+
+idle_stage_t idle_scheduler_update(uint32_t idle_ms, bool busy)
+{
+    idle_stage_t next = IDLE_ACTIVE;
+    if(!busy && idle_ms >= IDLE_SLOW_TIMEOUT)
+    {
+        next = IDLE_SLOW;
+    }
+    else if(!busy && idle_ms >= IDLE_QUIET_TIMEOUT)
+    {
+        next = IDLE_QUIET;
+    }
+
+    if(next != stage)
+    {
+        dprintf("Idle: stage %u -> %u after %lu ms.\n", stage, next, idle_ms);
+        stage = next;
+    }
+    return stage;
+}
+
+idle_stage_t idle_scheduler_stage(void)
+{
+    return stage;
+}
+
+uint16_t idle_scheduler_wake_bound(void)
+{
+    return wake_bound;
+}
+
+idle_stage_t idle_scheduler_task(void)
+{
+    if(!is_keyboard_master())
+    {
+        return IDLE_ACTIVE;
+    }
+
+    const idle_stage_t previous = stage;
+    idle_scheduler_update(last_input_activity_elapsed(), idle_busy_user());
+
+    if(previous == IDLE_SLOW && stage != IDLE_SLOW)
+    {
+        // The key went down at the earliest when the last sleep started.
+        const uint16_t bound = timer_elapsed(last_sleep);
+        wake_bound           = MAX(wake_bound, bound);
+        dprintf("Idle: woke within %u ms.\n", bound);
+    }
+    if(stage == IDLE_SLOW)
+    {
+        last_sleep = timer_read();
+        wait_ms(IDLE_SLOW_SCAN_INTERVAL);
+    }
+    return stage;
+}
+
+__attribute__((weak)) bool idle_busy_user(void)
+{
+    return false;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "quantum.h"
+
+/**
+ * Steps the master half down while nobody types.
+ *
+ * After IDLE_QUIET_TIMEOUT without matrix activity the stage turns quiet,
+ * which callers use to skip housekeeping work such as the indicator. After
+ * IDLE_SLOW_TIMEOUT the master sleeps IDLE_SLOW_SCAN_INTERVAL ms per pass of
+ * the main loop, stepping the scan down from over 1 kHz to about 100 Hz and
+ * letting the MCU idle in between. USB is interrupt driven and keeps working.
+ * QMK's split transactions are driven by the master's scan, so they step down
+ * with it; the matrix transaction can't stop, the slave's keys have to wake
+ * the master. Callers pause their own split syncs in the slow stage, see
+ * `matrix_scan_user()` in keymap.c. The slave keeps its own rate.
+ *
+ * QMK resets the activity timer in the same `keyboard_task()` that sees a
+ * matrix change, before housekeeping runs, so the pass after the first
+ * changed scan is back at full rate. A press waits for that scan at most the
+ * time since the start of the last sleep, `idle_scheduler_wake_bound()`
+ * returns the longest such bound measured. It is not a press-to-report
+ * latency, the press itself can't be timed before it is scanned.
+ * `idle_scheduler_update()` takes the idle time as an argument so the state
+ * machine can be driven by a fake clock on the host.
+ */
+
+#ifndef IDLE_QUIET_TIMEOUT
+#define IDLE_QUIET_TIMEOUT 10000
+#endif
+
+#ifndef IDLE_SLOW_TIMEOUT
+#define IDLE_SLOW_TIMEOUT 60000
+#endif
+
+#ifndef IDLE_SLOW_SCAN_INTERVAL
+#define IDLE_SLOW_SCAN_INTERVAL 10
+#endif
+
+typedef enum
+{
+    IDLE_ACTIVE,
+    IDLE_QUIET,
+    IDLE_SLOW,
+} idle_stage_t;
+
+/** Call from `housekeeping_task_user()`, returns the current stage. May sleep. */
+idle_stage_t idle_scheduler_task(void);
+
+/** Advances the state machine to `idle_ms` of inactivity and returns the new stage. */
+idle_stage_t idle_scheduler_update(uint32_t idle_ms, bool busy);
+
+/** Returns the current stage. */
+idle_stage_t idle_scheduler_stage(void);
+
+/** Returns the longest time from the start of a sleep to the scan that woke from it, in ms. */
+uint16_t idle_scheduler_wake_bound(void);
+
+/** Optional callback, return true to stay active, e.g. while the mouse moves. */
+bool idle_busy_user(void);
@@ -0,0 +1,77 @@
+#include "indicator.h"
+
+static uint16_t status = 0;
+// Last status handled by indicator_task(), differs from status to force the first write.
+static uint16_t shown_status = UINT16_MAX;
+static bool led_on           = false;
+static uint8_t shown_rgb[3]  = {0, 0, 0};
+
+void indicator_init(void)
+{
+    setPinOutput(INDICATOR_LED_PIN);
+    indicator_write_led(false);
+    led_on = false;
+}
+
+void indicator_set(uint16_t flags, bool on)
+{
+    if(on)
+    {
+        status |= flags;
+    }
+    else
+    {
+        status &= ~flags;
+    }
+}
+
+void indicator_set_layer(uint8_t layer)
+{
+    status = (status & ~INDICATOR_LAYER_MASK) | ((uint16_t)layer << INDICATOR_LAYER_SHIFT);
+}
+
+uint16_t indicator_status(void)
+{
+    return status;
+}
+
+void indicator_task(void)
+{
+    if(status == shown_status)
+    {
+        return;
+    }
+    const bool first = shown_status == UINT16_MAX;
+    shown_status     = status;
+
+    const bool led = indicator_led_user(status);
+    if(led != led_on)
+    {
+        indicator_write_led(led);
+        led_on = led;
+    }
+
+    uint8_t rgb[3];
+    indicator_rgb_user(status, rgb);
+    if(first || memcmp(rgb, shown_rgb, sizeof(rgb)) != 0)
+    {
+        rgblight_setrgb_at(rgb[0], rgb[1], rgb[2], INDICATOR_RGB_INDEX);
+        memcpy(shown_rgb, rgb, sizeof(rgb));
+    }
+}
+
+__attribute__((weak)) bool indicator_led_user(uint16_t status)
+{
+    return (status & (INDICATOR_ONESHOT_SHIFT | INDICATOR_CAPS_WORD)) != 0;
+}
+
+__attribute__((weak)) void indicator_rgb_user(uint16_t status, uint8_t rgb[3])
+{
+    rgb[0] = rgb[1] = rgb[2] = 0;
+}
+
+__attribute__((weak)) void indicator_write_led(bool on)
+{
+    // Due to technical reasons, high is off and low is on.
+    writePin(INDICATOR_LED_PIN, !on);
+}
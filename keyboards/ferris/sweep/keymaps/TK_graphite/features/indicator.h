@@ -0,0 +1,60 @@
+#pragma once
+
+#include "quantum.h"
+
+/**
+ * Single owner of the status LED and the layer RGB indicator.
+ *
+ * Callers only update bits of a packed status word. `indicator_task()`
+ * derives the LED level and RGB color from it and touches the GPIO and
+ * rgblight only when the derived value differs from what was last written.
+ *
+ * The GPIO is driven through `indicator_write_led()`, a weak function, so a
+ * build without the pin can replace it. tests/test_indicator.c runs this
+ * module on the host against the QMK stub in tests/stub.
+ */
+
+// Bits of the packed status word.
+#define INDICATOR_ONESHOT_SHIFT (1 << 0)
+#define INDICATOR_CAPS_WORD     (1 << 1)
+#define INDICATOR_ALT_TAB       (1 << 2)
+#define INDICATOR_LAYER_SHIFT   8
+#define INDICATOR_LAYER_MASK    (0xFF << INDICATOR_LAYER_SHIFT)
+
+#define INDICATOR_LAYER(status) (((status) & INDICATOR_LAYER_MASK) >> INDICATOR_LAYER_SHIFT)
+
+#ifndef INDICATOR_LED_PIN
+#define INDICATOR_LED_PIN 24
+#endif
+
+#ifndef INDICATOR_RGB_INDEX
+#define INDICATOR_RGB_INDEX 0
+#endif
+
+/** Configures the LED pin and turns it off. Call from `keyboard_pre_init_user()`. */
+void indicator_init(void);
+
+/** Sets or clears `flags` in the status word. */
+void indicator_set(uint16_t flags, bool on);
+
+/** Stores the active layer in the status word. */
+void indicator_set_layer(uint8_t layer);
+
+/** Returns the current status word. */
+uint16_t indicator_status(void);
+
+/** Writes the LED and RGB if the status changed. Call from `housekeeping_task_user()`. */
+void indicator_task(void);
+
+/**
+ * Returns true if the status LED should be lit for `status`.
+ *
+ * The default lights it while one-shot Shift or Caps Word is on.
+ */
+bool indicator_led_user(uint16_t status);
+
+/** Fills `rgb` with the color to show for `status`. Defaults to black. */
+void indicator_rgb_user(uint16_t status, uint8_t rgb[3]);
+
+/** Drives the LED pin. The pin is active low. */
+void indicator_write_led(bool on);
@@ -0,0 +1,94 @@
+#include "key_history.h"
+
+static key_history_entry_t history[KEY_HISTORY_SIZE];
+// Index of the next write.
+static uint8_t head = 0;
+
+void key_history_push(uint16_t keycode, uint8_t mods)
+{
+    if(IS_QK_MODS(keycode) || keycode <= QK_BASIC_MAX)
+    {
+        const uint8_t basic = IS_QK_MODS(keycode) ? QK_MODS_GET_BASIC_KEYCODE(keycode) : keycode;
+        if(basic >= KC_A && basic <= KC_Z)
+        {
+            mods &= ~MOD_MASK_SHIFT;  // Repeat letters in the case they are typed in.
+        }
+    }
+    history[head] = (key_history_entry_t){keycode, mods};
+    head          = (head + 1) & (KEY_HISTORY_SIZE - 1);
+}
+
+key_history_entry_t key_history_get(uint8_t age)
+{
+    if(age >= KEY_HISTORY_SIZE)
+    {
+        return (key_history_entry_t){KC_NO, 0};
+    }
+    return history[(head - 1 - age) & (KEY_HISTORY_SIZE - 1)];
+}
+
+void process_key_history(uint16_t keycode, keyrecord_t* record)
+{
+    if(!record->event.pressed)
+    {
+        return;
+    }
+    if(IS_QK_MOD_TAP(keycode) || IS_QK_LAYER_TAP(keycode))
+    {
+        if(record->tap.count == 0)
+        {
+            return;  // Held as a mod or layer.
+        }
+        keycode = IS_QK_MOD_TAP(keycode) ? QK_MOD_TAP_GET_TAP_KEYCODE(keycode) : QK_LAYER_TAP_GET_TAP_KEYCODE(keycode);
+    }
+    // Only keys that type something, layer switches and custom keycodes are skipped.
+    if(IS_MODIFIER_KEYCODE(keycode) || keycode == KC_NO || keycode > QK_MODS_MAX)
+    {
+        return;
+    }
+    key_history_push(keycode, get_mods() | get_oneshot_mods());
+}
+
+static void tap_entry(key_history_entry_t entry)
+{
+    if(entry.keycode == KC_NO)
+    {
+        return;
+    }
+    if(entry.keycode > QK_MODS_MAX)
+    {
+        // Marker of a macro, which pushes it again.
+        key_history_replay_user(entry.keycode);
+        return;
+    }
+    add_weak_mods(entry.mods);
+    tap_code16(entry.keycode);
+    if(entry.mods)
+    {
+        del_weak_mods(entry.mods);
+        send_keyboard_report();
+    }
+    // Repeats are history too, so magic after a repeat sees the repeated key.
+    key_history_push(entry.keycode, entry.mods);
+}
+
+void key_history_repeat(void)
+{
+    tap_entry(key_history_get(0));
+}
+
+void key_history_magic(void)
+{
+    key_history_entry_t entry = key_history_get(0);
+    for(uint8_t i = 0; i < magic_table_count; ++i)
+    {
+        if(magic_table[i].last == entry.keycode)
+        {
+            entry.keycode = magic_table[i].next;
+            break;
+        }
+    }
+    tap_entry(entry);
+}
+
+__attribute__((weak)) void key_history_replay_user(uint16_t keycode) {}
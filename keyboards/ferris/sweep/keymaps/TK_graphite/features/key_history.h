@@ -0,0 +1,64 @@
+#pragma once
+
+#include "quantum.h"
+
+/**
+ * History of the last emitted keys, for Repeat and "magic" keys.
+ *
+ * `process_key_history()` records every key press that reaches
+ * `process_record_user()`, including taps re-plumbed by Achordion. Custom
+ * keycodes are not recorded by it; macros push the key they emit with
+ * `key_history_push()` instead. A macro typing several keys can push a custom
+ * keycode as a marker, which `key_history_replay_user()` types again in full.
+ * Each update is a single ring buffer write.
+ *
+ * The magic key looks up the last key in `magic_table` and types the listed
+ * continuation, e.g. to avoid a same-finger bigram. Without an entry it
+ * repeats the last key.
+ *
+ * QMK's Repeat Key (REPEAT_KEY_ENABLE) is not used: it replays the last
+ * keycode through `process_record()`, so the vim, leader, mod session and
+ * macro recorder handlers would act on a repeat as on a new key, and it only
+ * keeps the last key where magic needs the history with Shift stripped from
+ * letters.
+ */
+
+#ifndef KEY_HISTORY_SIZE
+#define KEY_HISTORY_SIZE 8
+#endif
+
+_Static_assert((KEY_HISTORY_SIZE & (KEY_HISTORY_SIZE - 1)) == 0, "KEY_HISTORY_SIZE must be a power of two");
+
+typedef struct
+{
+    uint16_t keycode;
+    // 8-bit mods held with the key, without Shift on letters.
+    uint8_t mods;
+} key_history_entry_t;
+
+typedef struct
+{
+    uint16_t last;
+    uint16_t next;
+} magic_t;
+
+extern const magic_t magic_table[];
+extern const uint8_t magic_table_count;
+
+/** Records pressed keys. Call from `process_record_user()`, never consumes the event. */
+void process_key_history(uint16_t keycode, keyrecord_t* record);
+
+/** Records that `keycode` was sent with `mods`. */
+void key_history_push(uint16_t keycode, uint8_t mods);
+
+/** Returns the entry `age` keys ago, 0 being the last one. Empty entries are KC_NO. */
+key_history_entry_t key_history_get(uint8_t age);
+
+/** Optional callback typing the keys of a marker pushed by a macro, see above. */
+void key_history_replay_user(uint16_t keycode);
+
+/** Types the last key again. */
+void key_history_repeat(void);
+
+/** Types the magic continuation of the last key, or repeats it. */
+void key_history_magic(void);
@@ -0,0 +1,13 @@
+#include "key_trace.h"
+
+void pre_process_key_trace(uint16_t keycode, keyrecord_t* record)
+{
+    uprintf("ev %u,%u %04X %c L%u M%02X @%u\n",
+            record->event.key.row,
+            record->event.key.col,
+            keycode,
+            record->event.pressed ? 'd' : 'u',
+            get_highest_layer(layer_state | default_layer_state),
+            get_mods(),
+            record->event.time);
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "quantum.h"
+
+/**
+ * Console trace of key events, a debugging aid for following what the
+ * keymap is given. Build with `KEY_TRACE_ENABLE=yes` and every physical key
+ * event is printed with `uprintf()` as
+ *
+ *     ev <row>,<col> <keycode> <d|u> L<layer> M<mods> @<time>
+ *
+ * before combos and Achordion see it. The mods are those registered when the
+ * event arrives. QMK's debug output is left as configured, so other debug
+ * prints only show up when turned on separately.
+ *
+ * The trace shows the input side only: it doesn't print the reports sent to
+ * the host, so two traces matching doesn't mean two builds behave the same.
+ */
+
+/** Call from `pre_process_record_user()`, never consumes the event. */
+void pre_process_key_trace(uint16_t keycode, keyrecord_t* record);
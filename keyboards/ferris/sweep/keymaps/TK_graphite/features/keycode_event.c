@@ -0,0 +1,13 @@
+#include "keycode_event.h"
+
+void keycode_event(uint16_t keycode, bool pressed)
+{
+    keyrecord_t record = {.event = MAKE_COMBOEVENT(pressed), .keycode = keycode};
+    process_record(&record);
+}
+
+void keycode_tap(uint16_t keycode)
+{
+    keycode_event(keycode, true);
+    keycode_event(keycode, false);
+}
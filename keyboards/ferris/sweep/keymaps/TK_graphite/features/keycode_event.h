@@ -0,0 +1,17 @@
+#pragma once
+
+#include "quantum.h"
+
+/**
+ * Keycodes sent as if they were on the keymap.
+ *
+ * The event goes through `process_record()` like a combo's, so custom
+ * keycodes, layer keys and the `process_record_user()` features all see it,
+ * which `tap_code16()` would skip.
+ */
+
+/** Presses or releases `keycode`. */
+void keycode_event(uint16_t keycode, bool pressed);
+
+/** Presses and releases `keycode`. */
+void keycode_tap(uint16_t keycode);
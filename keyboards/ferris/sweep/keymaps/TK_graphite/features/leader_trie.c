@@ -0,0 +1,85 @@
+#include "leader_trie.h"
+#include "keycode_event.h"
+
+#define LEAF 0x8000
+
+static bool active                = false;
+// Offset of the current node in `leader_trie`.
+static uint16_t node              = 0;
+static deferred_token abort_token = INVALID_DEFERRED_TOKEN;
+
+static void leader_trie_stop(void)
+{
+    active = false;
+    cancel_deferred_exec(abort_token);
+    abort_token = INVALID_DEFERRED_TOKEN;
+}
+
+static uint32_t abort_callback(uint32_t trigger_time, void* cb_arg)
+{
+    dprintln("Leader: idle, aborted.");
+    abort_token = INVALID_DEFERRED_TOKEN;
+    active      = false;
+    return 0;
+}
+
+void leader_trie_start(void)
+{
+    leader_trie_stop();
+    active      = true;
+    node        = 0;
+    abort_token = defer_exec(LEADER_TRIE_IDLE_TIMEOUT, abort_callback, NULL);
+}
+
+bool leader_trie_active(void)
+{
+    return active;
+}
+
+bool process_leader_trie(uint16_t keycode, keyrecord_t* record)
+{
+    // Releases of the sequence keys are harmless, their presses never reached QMK.
+    if(!active || !record->event.pressed || IS_MODIFIER_KEYCODE(keycode))
+    {
+        return true;
+    }
+    if((IS_QK_MOD_TAP(keycode) || IS_QK_LAYER_TAP(keycode)) && record->tap.count == 0)
+    {
+        return true;  // Held, acts as a mod or layer.
+    }
+    if(IS_QK_MOD_TAP(keycode))
+    {
+        keycode = QK_MOD_TAP_GET_TAP_KEYCODE(keycode);
+    }
+    else if(IS_QK_LAYER_TAP(keycode))
+    {
+        keycode = QK_LAYER_TAP_GET_TAP_KEYCODE(keycode);
+    }
+
+    const uint16_t count = pgm_read_word(&leader_trie[node]);
+    for(uint16_t i = node + 1; i < node + 1 + 2 * count; i += 2)
+    {
+        if(pgm_read_word(&leader_trie[i]) != keycode)
+        {
+            continue;
+        }
+        const uint16_t next = pgm_read_word(&leader_trie[i + 1]);
+        if(next & LEAF)
+        {
+            leader_trie_stop();
+            const uint16_t action = pgm_read_word(&leader_actions[next & ~LEAF]);
+            dprintf("Leader: action 0x%04X.\n", action);
+            keycode_tap(action);
+        }
+        else
+        {
+            node = next;
+            extend_deferred_exec(abort_token, LEADER_TRIE_IDLE_TIMEOUT);
+        }
+        return false;
+    }
+
+    dprintf("Leader: no sequence continues with 0x%04X, aborted.\n", keycode);
+    leader_trie_stop();
+    return false;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "quantum.h"
+
+/**
+ * Leader sequences matched against a trie in flash.
+ *
+ * Sequences are declared in leader.def and compiled by make_leader_data.py
+ * into `leader_trie` and `leader_actions` (leader_data.h, included from
+ * keymap.c). After `leader_trie_start()` every key press takes one step down
+ * the trie: a complete sequence fires its action right away, and a key that
+ * continues no sequence aborts the leader, so nothing waits for a timeout.
+ * The idle timeout only catches an abandoned leader.
+ *
+ * Actions are keycodes, tapped through `process_record()` so custom keycodes
+ * and layer keys work like they do in the keymap.
+ */
+
+#ifndef LEADER_TRIE_IDLE_TIMEOUT
+#define LEADER_TRIE_IDLE_TIMEOUT 2000
+#endif
+
+// Deferred executors scheduled at most at the same time.
+#define LEADER_TRIE_DEFERRED_EXECUTORS 1
+
+extern const uint16_t leader_trie[];
+extern const uint16_t leader_actions[];
+
+/** Handler, call from `process_record_user()`. Returns false while a sequence is being typed. */
+bool process_leader_trie(uint16_t keycode, keyrecord_t* record);
+
+/** Starts reading a sequence. */
+void leader_trie_start(void);
+
+/** Returns true while a sequence is being typed. */
+bool leader_trie_active(void);
@@ -0,0 +1,328 @@
+#include "macro_recorder.h"
+#include "keycode_event.h"
+
+enum
+{
+    KIND_PRESS,
+    KIND_RELEASE,
+    KIND_RELEASE_LAST,
+    KIND_REPEAT,
+};
+
+// Keys still held when recording stops get a release appended, one RELEASE each.
+#define HELD_MAX     4
+#define RELEASE_SIZE 4
+
+// REPEAT delays are stored in these units, so the header always fits a byte.
+#define REPEAT_DELAY_UNIT 4
+_Static_assert((MACRO_RECORDER_MAX_DELAY + REPEAT_DELAY_UNIT / 2) / REPEAT_DELAY_UNIT < 0x20, "MACRO_RECORDER_MAX_DELAY is too long for a one byte REPEAT");
+
+typedef struct
+{
+    uint8_t length;
+    uint8_t data[MACRO_RECORDER_SIZE];
+} macro_t;
+
+_Static_assert(sizeof(macro_t) <= EECONFIG_USER_DATA_SIZE, "EECONFIG_USER_DATA_SIZE is too small for the macro");
+
+static macro_t macro;
+static bool recording = false;
+static bool playing   = false;
+
+// Recording state.
+static uint16_t last_time;
+static uint16_t held[HELD_MAX];
+static bool last_was_press;
+static uint16_t last_press_keycode;
+static uint8_t last_press_offset;
+static uint16_t last_press_delay;
+static bool has_last_tap;
+static uint16_t last_tap_keycode;
+
+// Playback state, the last tap is tracked the same way to expand REPEAT.
+static uint8_t cursor;
+static uint16_t play_last_press;
+static uint16_t play_last_tap;
+static uint16_t play_last_hold;
+static bool play_release_pending;
+
+static bool write_event(uint16_t delay, uint8_t kind, bool with_keycode, uint16_t keycode)
+{
+    uint16_t header = (delay << 2) | kind;
+    uint8_t bytes[5];
+    uint8_t size = 0;
+    do
+    {
+        bytes[size++] = (header & 0x7F) | (header > 0x7F ? 0x80 : 0);
+        header >>= 7;
+    } while(header);
+    if(with_keycode)
+    {
+        bytes[size++] = keycode & 0xFF;
+        bytes[size++] = keycode >> 8;
+    }
+    if(macro.length + size > MACRO_RECORDER_SIZE - HELD_MAX * RELEASE_SIZE)
+    {
+        return false;
+    }
+    memcpy(&macro.data[macro.length], bytes, size);
+    macro.length += size;
+    return true;
+}
+
+static void set_held(uint16_t keycode, bool pressed)
+{
+    for(uint8_t i = 0; i < HELD_MAX; ++i)
+    {
+        if(pressed ? held[i] == KC_NO : held[i] == keycode)
+        {
+            held[i] = pressed ? keycode : KC_NO;
+            return;
+        }
+    }
+}
+
+static void start_recording(void)
+{
+    dprintln("Macro: recording.");
+    memset(&macro, 0, sizeof(macro));
+    memset(held, 0, sizeof(held));
+    last_time      = timer_read();
+    last_was_press = false;
+    has_last_tap   = false;
+    recording      = true;
+}
+
+static void stop_recording(void)
+{
+    recording = false;
+    // Leave nothing stuck down after playback.
+    for(uint8_t i = 0; i < HELD_MAX; ++i)
+    {
+        if(held[i] != KC_NO)
+        {
+            // A zero delay RELEASE header fits in one byte.
+            macro.data[macro.length++] = KIND_RELEASE;
+            macro.data[macro.length++] = held[i] & 0xFF;
+            macro.data[macro.length++] = held[i] >> 8;
+        }
+    }
+    eeconfig_update_user_datablock(&macro, 0, sizeof(macro));
+    dprintf("Macro: recorded %u bytes.\n", macro.length);
+}
+
+static uint16_t recorded_keycode(uint16_t keycode, keyrecord_t* record)
+{
+    if(IS_QK_MOD_TAP(keycode))
+    {
+        // Held mod-taps are recorded as their mods alone, e.g. LCTL(KC_NO).
+        return record->tap.count ? QK_MOD_TAP_GET_TAP_KEYCODE(keycode) : (uint16_t)QK_MOD_TAP_GET_MODS(keycode) << 8;
+    }
+    if(IS_QK_LAYER_TAP(keycode))
+    {
+        return record->tap.count ? QK_LAYER_TAP_GET_TAP_KEYCODE(keycode) : KC_NO;
+    }
+    if(IS_QK_TO(keycode) || IS_QK_MOMENTARY(keycode) || IS_QK_DEF_LAYER(keycode) || IS_QK_TOGGLE_LAYER(keycode) || IS_QK_ONE_SHOT_LAYER(keycode) || IS_QK_LAYER_TAP_TOGGLE(keycode) || IS_QK_LAYER_MOD(keycode))
+    {
+        return KC_NO;
+    }
+    return macro_recorder_skip_user(keycode) ? KC_NO : keycode;
+}
+
+void process_macro_recorder(uint16_t keycode, keyrecord_t* record)
+{
+    if(!recording || playing)
+    {
+        return;
+    }
+    keycode = recorded_keycode(keycode, record);
+    if(keycode == KC_NO)
+    {
+        return;
+    }
+
+    const uint16_t now = timer_read();
+    uint16_t delay     = TIMER_DIFF_16(now, last_time);
+    delay              = delay < MACRO_RECORDER_MAX_DELAY ? delay : MACRO_RECORDER_MAX_DELAY;
+    last_time          = now;
+
+    bool written;
+    if(record->event.pressed)
+    {
+        const uint8_t offset = macro.length;
+        written              = write_event(delay, KIND_PRESS, true, keycode);
+        if(last_was_press)
+        {
+            has_last_tap = false;  // Overlapping presses, no tap to repeat.
+        }
+        last_was_press     = true;
+        last_press_keycode = keycode;
+        last_press_offset  = offset;
+        last_press_delay   = delay;
+    }
+    else if(last_was_press && keycode == last_press_keycode)
+    {
+        if(has_last_tap && keycode == last_tap_keycode)
+        {
+            // Same tap again: replace its press by a one byte REPEAT.
+            macro.length = last_press_offset;
+            written      = write_event((last_press_delay + REPEAT_DELAY_UNIT / 2) / REPEAT_DELAY_UNIT, KIND_REPEAT, false, KC_NO);
+        }
+        else
+        {
+            written          = write_event(delay, KIND_RELEASE_LAST, false, KC_NO);
+            has_last_tap     = true;
+            last_tap_keycode = keycode;
+        }
+        last_was_press = false;
+    }
+    else
+    {
+        written        = write_event(delay, KIND_RELEASE, true, keycode);
+        has_last_tap   = false;
+        last_was_press = false;
+    }
+    if(!written)
+    {
+        dprintln("Macro: full.");
+        stop_recording();
+        return;
+    }
+    set_held(keycode, record->event.pressed);
+}
+
+void macro_recorder_toggle(void)
+{
+    if(playing)
+    {
+        return;
+    }
+    if(recording)
+    {
+        stop_recording();
+    }
+    else
+    {
+        start_recording();
+    }
+}
+
+static uint16_t header_delay(uint16_t header)
+{
+    const uint16_t delay = header >> 2;
+    return (header & 3) == KIND_REPEAT ? delay * REPEAT_DELAY_UNIT : delay;
+}
+
+// Milliseconds to wait before the next event.
+static uint16_t playback_delay(uint16_t delay)
+{
+#ifdef MACRO_RECORDER_FAST_PLAYBACK
+    return 1;
+#else
+    return delay ? delay : 1;
+#endif
+}
+
+static uint16_t read_varint(void)
+{
+    uint16_t value = 0;
+    for(uint8_t shift = 0; cursor < macro.length && shift < 16; shift += 7)
+    {
+        const uint8_t byte = macro.data[cursor++];
+        value |= (uint16_t)(byte & 0x7F) << shift;
+        if(!(byte & 0x80))
+        {
+            break;
+        }
+    }
+    return value;
+}
+
+static uint16_t read_keycode(void)
+{
+    if(cursor + 2 > macro.length)
+    {
+        cursor = macro.length;
+        return KC_NO;
+    }
+    const uint16_t keycode = macro.data[cursor] | (macro.data[cursor + 1] << 8);
+    cursor += 2;
+    return keycode;
+}
+
+// Returns the delay before the next event, 0 once done.
+static uint32_t play_callback(uint32_t trigger_time, void* cb_arg)
+{
+    if(play_release_pending)
+    {
+        play_release_pending = false;
+        keycode_event(play_last_tap, false);
+    }
+    else
+    {
+        const uint16_t header = read_varint();
+        switch(header & 3)
+        {
+        case KIND_PRESS:
+            play_last_press = read_keycode();
+            keycode_event(play_last_press, true);
+            break;
+        case KIND_RELEASE:
+            keycode_event(read_keycode(), false);
+            break;
+        case KIND_RELEASE_LAST:
+            play_last_tap  = play_last_press;
+            play_last_hold = header >> 2;
+            keycode_event(play_last_tap, false);
+            break;
+        case KIND_REPEAT:
+            keycode_event(play_last_tap, true);
+            play_release_pending = true;
+            return playback_delay(play_last_hold);
+        }
+    }
+
+    if(cursor >= macro.length)
+    {
+        playing = false;
+        return 0;
+    }
+    // Peek at the next delay.
+    const uint8_t next    = cursor;
+    const uint16_t header = read_varint();
+    cursor                = next;
+    return playback_delay(header_delay(header));
+}
+
+void macro_recorder_play(void)
+{
+    if(recording || playing || macro.length == 0)
+    {
+        return;
+    }
+    playing              = true;
+    cursor               = 0;
+    play_last_press      = KC_NO;
+    play_last_tap        = KC_NO;
+    play_last_hold       = 0;
+    play_release_pending = false;
+    defer_exec(1, play_callback, NULL);
+}
+
+void macro_recorder_init(void)
+{
+    if(!eeconfig_is_user_datablock_valid())
+    {
+        return;
+    }
+    eeconfig_read_user_datablock(&macro, 0, sizeof(macro));
+    if(macro.length > MACRO_RECORDER_SIZE)
+    {
+        macro.length = 0;
+    }
+}
+
+__attribute__((weak)) bool macro_recorder_skip_user(uint16_t keycode)
+{
+    return false;
+}
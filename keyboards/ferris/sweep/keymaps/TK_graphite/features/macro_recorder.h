@@ -0,0 +1,58 @@
+#pragma once
+
+#include "quantum.h"
+
+/**
+ * Dynamic macro recorded from the keys `process_record_user()` sees.
+ *
+ * Recording starts after Achordion and the thumb layers, so it stores what
+ * they resolved: tapped mod-taps as their key, held ones as their mods.
+ * Layer keys are left out, their effect is already in the keycodes that
+ * follow them.
+ *
+ * Events are packed into a fixed arena. Each one is a varint of the delay
+ * since the previous event (capped at MACRO_RECORDER_MAX_DELAY) shifted
+ * left by 2, plus the kind:
+ *
+ *  * PRESS, RELEASE: followed by the keycode, 2 bytes.
+ *  * RELEASE_LAST: releases the key of the previous press, no keycode.
+ *  * REPEAT: taps the last tapped key again with the same hold time. Its
+ *    delay is stored in 4 ms units, so repeated taps cost one byte each.
+ *
+ * The macro is saved to the EEPROM user datablock when recording stops and
+ * loaded by `macro_recorder_init()`. Playback runs on the deferred executor
+ * and never blocks the scan loop. It keeps the recorded delays, unless
+ * MACRO_RECORDER_FAST_PLAYBACK is defined: then it sends one event per
+ * millisecond, the fastest the executor runs.
+ *
+ * Needs `EECONFIG_USER_DATA_SIZE (MACRO_RECORDER_SIZE + 1)` in config.h and
+ * `DEFERRED_EXEC_ENABLE = yes`.
+ */
+
+#ifndef MACRO_RECORDER_SIZE
+#define MACRO_RECORDER_SIZE 200
+#endif
+
+_Static_assert(MACRO_RECORDER_SIZE <= UINT8_MAX, "The macro length is stored in one byte");
+
+#ifndef MACRO_RECORDER_MAX_DELAY
+#define MACRO_RECORDER_MAX_DELAY 100
+#endif
+
+// Deferred executors scheduled at most at the same time.
+#define MACRO_RECORDER_DEFERRED_EXECUTORS 1
+
+/** Loads the saved macro. Call from `keyboard_post_init_user()`. */
+void macro_recorder_init(void);
+
+/** Records events while recording. Call from `process_record_user()`, never consumes the event. */
+void process_macro_recorder(uint16_t keycode, keyrecord_t* record);
+
+/** Starts recording, or stops and saves the macro if recording. */
+void macro_recorder_toggle(void);
+
+/** Plays the macro, unless recording or already playing. */
+void macro_recorder_play(void);
+
+/** Optional callback, return true for keys never to record, e.g. the recorder keys. */
+bool macro_recorder_skip_user(uint16_t keycode);
@@ -0,0 +1,122 @@
+#include "mod_session.h"
+
+static uint8_t active = 0;
+static deferred_token tokens[MOD_SESSION_MAX];
+// Mods held by physical keys, e.g. a home row Alt, which sessions must not release.
+static uint8_t key_mods = 0;
+
+// Converts the 5-bit mods of a mod-tap keycode to an 8-bit mod mask.
+static uint8_t mod_tap_mods(uint16_t keycode)
+{
+    const uint8_t mods = QK_MOD_TAP_GET_MODS(keycode);
+    return (mods & 0x10) ? (mods & 0x0F) << 4 : mods;
+}
+
+static void track_key_mods(uint16_t keycode, keyrecord_t* record)
+{
+    uint8_t mods = 0;
+    if(IS_MODIFIER_KEYCODE(keycode))
+    {
+        mods = MOD_BIT(keycode);
+    }
+    else if(IS_QK_MOD_TAP(keycode) && record->tap.count == 0)
+    {
+        mods = mod_tap_mods(keycode);
+    }
+
+    if(record->event.pressed)
+    {
+        key_mods |= mods;
+    }
+    else
+    {
+        key_mods &= ~mods;
+    }
+}
+
+static void end_session(uint8_t index)
+{
+    active &= ~(1 << index);
+    tokens[index] = INVALID_DEFERRED_TOKEN;
+
+    // Keep mods that another running session or a held key still relies on.
+    uint8_t still_held = key_mods;
+    for(uint8_t i = 0; i < mod_sessions_count; ++i)
+    {
+        if(active & (1 << i))
+        {
+            still_held |= mod_sessions[i].mods;
+        }
+    }
+    unregister_mods(mod_sessions[index].mods & ~still_held);
+    mod_session_changed_user(active);
+}
+
+static uint32_t session_timeout_callback(uint32_t trigger_time, void* cb_arg)
+{
+    end_session((uint8_t)(uintptr_t)cb_arg);
+    return 0;
+}
+
+void mod_session_end_all(void)
+{
+    for(uint8_t i = 0; i < mod_sessions_count; ++i)
+    {
+        if(active & (1 << i))
+        {
+            cancel_deferred_exec(tokens[i]);
+            end_session(i);
+        }
+    }
+}
+
+uint8_t mod_session_active(void)
+{
+    return active;
+}
+
+bool process_mod_session(uint16_t keycode, keyrecord_t* record)
+{
+    track_key_mods(keycode, record);
+    for(uint8_t i = 0; i < mod_sessions_count; ++i)
+    {
+        const mod_session_t* session = &mod_sessions[i];
+        if(keycode != session->keycode)
+        {
+            continue;
+        }
+
+        if(record->event.pressed)
+        {
+            if(active & (1 << i))
+            {
+                extend_deferred_exec(tokens[i], session->timeout);
+            }
+            else
+            {
+                register_mods(session->mods);
+                tokens[i] = defer_exec(session->timeout, session_timeout_callback, (void*)(uintptr_t)i);
+                active |= 1 << i;
+                mod_session_changed_user(active);
+            }
+            register_code16(session->tap);
+        }
+        else
+        {
+            unregister_code16(session->tap);
+        }
+        return false;
+    }
+
+    // Any other key ends the sessions before it is handled. Modifiers and
+    // tap-hold holds don't, so that e.g. Shift can reverse the direction of
+    // Alt-Tab and the layer key can be pressed again to continue the session.
+    const bool is_hold = (IS_QK_MOD_TAP(keycode) || IS_QK_LAYER_TAP(keycode)) && record->tap.count == 0;
+    if(active && record->event.pressed && !is_hold && !IS_MODIFIER_KEYCODE(keycode) && !IS_QK_ONE_SHOT_MOD(keycode))
+    {
+        mod_session_end_all();
+    }
+    return true;
+}
+
+__attribute__((weak)) void mod_session_changed_user(uint8_t active) {}
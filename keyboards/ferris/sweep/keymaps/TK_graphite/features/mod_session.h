@@ -0,0 +1,62 @@
+#pragma once
+
+#include "quantum.h"
+
+/**
+ * Sticky-modifier sessions, the generalization of the classic Alt-Tab macro.
+ *
+ * Pressing a session key registers the session's mods (if not already held)
+ * and taps its key, e.g. Alt + Tab. Further presses only tap the key again.
+ * The mods are released when the session's timeout expires after the last
+ * press, or right away when any other non-modifier key is pressed. Several
+ * sessions can be active at once; a mod is only released once no remaining
+ * session needs it and no modifier or mod-tap key holds it.
+ *
+ * Timeouts are scheduled with the deferred executor, so nothing is polled.
+ * Each active session holds one executor, see MOD_SESSION_DEFERRED_EXECUTORS.
+ * Requires `DEFERRED_EXEC_ENABLE = yes`.
+ *
+ * Define the sessions in keymap.c:
+ *
+ *     const mod_session_t mod_sessions[] = {
+ *         {ALTTAB, KC_TAB, MOD_BIT(KC_LALT), 1000},
+ *     };
+ *     const uint8_t mod_sessions_count = ARRAY_SIZE(mod_sessions);
+ *     _Static_assert(ARRAY_SIZE(mod_sessions) <= MOD_SESSION_MAX, "Too many mod sessions");
+ *
+ * and call `process_mod_session()` from `process_record_user()`.
+ */
+
+#ifndef MOD_SESSION_MAX
+#define MOD_SESSION_MAX 8
+#endif
+
+// Deferred executors scheduled at most, per session.
+#define MOD_SESSION_DEFERRED_EXECUTORS 1
+
+typedef struct
+{
+    // Key that starts or continues the session.
+    uint16_t keycode;
+    // Key held while the session key is held. May carry mods, e.g. LSFT(KC_TAB).
+    uint16_t tap;
+    // 8-bit mod mask held for the lifetime of the session.
+    uint8_t mods;
+    // Time in ms after the last press before the mods are released.
+    uint16_t timeout;
+} mod_session_t;
+
+extern const mod_session_t mod_sessions[];
+extern const uint8_t mod_sessions_count;
+
+/** Handles session keys. Returns false if the event was consumed. */
+bool process_mod_session(uint16_t keycode, keyrecord_t* record);
+
+/** Ends every active session and releases its mods. */
+void mod_session_end_all(void);
+
+/** Returns a bitmask of active sessions, bit i is `mod_sessions[i]`. */
+uint8_t mod_session_active(void);
+
+/** Optional callback invoked whenever the set of active sessions changes. */
+void mod_session_changed_user(uint8_t active);
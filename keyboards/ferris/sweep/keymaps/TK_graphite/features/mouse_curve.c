@@ -0,0 +1,90 @@
+#include "mouse_curve.h"
+
+static int16_t scale(int16_t value, uint16_t factor)
+{
+    return (int32_t)value * factor / 256;
+}
+
+static int16_t step_velocity(int16_t velocity, int8_t dir, int16_t max_speed, int16_t accel, uint16_t elapsed)
+{
+    if(dir == 0)
+    {
+        // Glide: exponential decay, one ms at a time to stay exact in fixed point.
+        for(uint16_t i = 0; i < elapsed && velocity != 0; ++i)
+        {
+            velocity -= scale(velocity, MOUSE_CURVE_FRICTION);
+            if(velocity < MOUSE_CURVE_STOP_SPEED && velocity > -MOUSE_CURVE_STOP_SPEED)
+            {
+                velocity = 0;
+            }
+        }
+        return velocity;
+    }
+
+    int32_t speed = (int32_t)velocity * dir;
+    if(speed < MOUSE_CURVE_START_SPEED)
+    {
+        speed = MOUSE_CURVE_START_SPEED;  // Started or reversed.
+    }
+    speed += (int32_t)accel * elapsed;
+    if(speed > max_speed)
+    {
+        speed = max_speed;
+    }
+    return speed * dir;
+}
+
+static int8_t step_position(int16_t* remainder, int16_t velocity, uint16_t elapsed)
+{
+    int32_t position = *remainder + (int32_t)velocity * elapsed;
+    int32_t pixels   = position / 256;
+    if(pixels > 127)
+    {
+        pixels = 127;
+    }
+    else if(pixels < -127)
+    {
+        pixels = -127;
+    }
+    *remainder = position - pixels * 256;
+    return pixels;
+}
+
+void mouse_curve_step(mouse_curve_t* curve, int8_t dir_x, int8_t dir_y, bool precise, uint16_t elapsed, int8_t* x, int8_t* y)
+{
+    if(elapsed > MOUSE_CURVE_MAX_STEP)
+    {
+        elapsed = MOUSE_CURVE_MAX_STEP;
+    }
+
+    int16_t max_speed = MOUSE_CURVE_MAX_SPEED;
+    int16_t accel     = MOUSE_CURVE_ACCEL;
+    if(precise)
+    {
+        max_speed = scale(max_speed, MOUSE_CURVE_PRECISION);
+        accel     = scale(accel, MOUSE_CURVE_PRECISION);
+        accel     = accel ? accel : 1;  // Keep accelerating, if slowly.
+    }
+    if(dir_x && dir_y)
+    {
+        max_speed = scale(max_speed, MOUSE_CURVE_DIAGONAL);
+    }
+
+    curve->velocity_x = step_velocity(curve->velocity_x, dir_x, max_speed, accel, elapsed);
+    curve->velocity_y = step_velocity(curve->velocity_y, dir_y, max_speed, accel, elapsed);
+    if(curve->velocity_x == 0)
+    {
+        curve->remainder_x = 0;
+    }
+    if(curve->velocity_y == 0)
+    {
+        curve->remainder_y = 0;
+    }
+    *x = step_position(&curve->remainder_x, curve->velocity_x, elapsed);
+    *y = step_position(&curve->remainder_y, curve->velocity_y, elapsed);
+}
+
+bool mouse_curve_moving(const mouse_curve_t* curve)
+{
+    return curve->velocity_x != 0 || curve->velocity_y != 0;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Fixed-point velocity curve of the mouse keys.
+ *
+ * Pure functions of the held directions and the elapsed time, without any
+ * QMK dependency, so the curve can be stepped and plotted on the host.
+ *
+ * Velocities are in 1/256 px per ms, positions in 1/256 px. While a direction
+ * is held the axis jumps to the start speed and accelerates linearly up to
+ * the max speed. Once released it keeps gliding and decays by the friction
+ * factor every ms. Diagonals are scaled by 1/sqrt(2) so they are not faster
+ * than straight moves, and precision mode scales speed and acceleration.
+ */
+
+// 1/256 px per ms.
+#ifndef MOUSE_CURVE_START_SPEED
+#define MOUSE_CURVE_START_SPEED 64
+#endif
+#ifndef MOUSE_CURVE_MAX_SPEED
+#define MOUSE_CURVE_MAX_SPEED 640
+#endif
+// 1/256 px per ms, gained every ms.
+#ifndef MOUSE_CURVE_ACCEL
+#define MOUSE_CURVE_ACCEL 2
+#endif
+// Velocity lost every ms without input, in 1/256 of the velocity.
+#ifndef MOUSE_CURVE_FRICTION
+#define MOUSE_CURVE_FRICTION 24
+#endif
+// Glides slower than this stop, in 1/256 px per ms.
+#ifndef MOUSE_CURVE_STOP_SPEED
+#define MOUSE_CURVE_STOP_SPEED 16
+#endif
+// Speed and acceleration multiplier of precision mode, in 1/256.
+#ifndef MOUSE_CURVE_PRECISION
+#define MOUSE_CURVE_PRECISION 64
+#endif
+// 256 / sqrt(2)
+#define MOUSE_CURVE_DIAGONAL 181
+
+// Longest step, so a stalled scan doesn't turn into a jump.
+#define MOUSE_CURVE_MAX_STEP 16
+
+typedef struct
+{
+    int16_t velocity_x;
+    int16_t velocity_y;
+    // Sub-pixel remainder not reported yet.
+    int16_t remainder_x;
+    int16_t remainder_y;
+} mouse_curve_t;
+
+/**
+ * Advances `curve` by `elapsed` ms with the held directions `dir_x` and
+ * `dir_y` (-1, 0 or 1) and returns the whole pixels moved in `x` and `y`.
+ */
+void mouse_curve_step(mouse_curve_t* curve, int8_t dir_x, int8_t dir_y, bool precise, uint16_t elapsed, int8_t* x, int8_t* y);
+
+/** Returns true while the pointer is moving or gliding. */
+bool mouse_curve_moving(const mouse_curve_t* curve);
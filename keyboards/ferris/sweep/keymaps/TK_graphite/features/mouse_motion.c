@@ -0,0 +1,92 @@
+#include "mouse_motion.h"
+
+enum
+{
+    HELD_UP      = 1 << 0,
+    HELD_DOWN    = 1 << 1,
+    HELD_LEFT    = 1 << 2,
+    HELD_RIGHT   = 1 << 3,
+    HELD_PRECISE = 1 << 4,
+};
+
+static uint8_t held        = 0;
+static mouse_curve_t curve = {0};
+static uint16_t last_step  = 0;
+
+static uint8_t held_flag(uint16_t keycode)
+{
+    switch(keycode)
+    {
+    case KC_MS_UP:
+        return HELD_UP;
+    case KC_MS_DOWN:
+        return HELD_DOWN;
+    case KC_MS_LEFT:
+        return HELD_LEFT;
+    case KC_MS_RIGHT:
+        return HELD_RIGHT;
+    case KC_MS_ACCEL0:
+        return HELD_PRECISE;
+    default:
+        return 0;
+    }
+}
+
+bool mouse_motion_active(void)
+{
+    return (held & (HELD_UP | HELD_DOWN | HELD_LEFT | HELD_RIGHT)) || mouse_curve_moving(&curve);
+}
+
+bool process_mouse_motion(uint16_t keycode, keyrecord_t* record)
+{
+    const uint8_t flag = held_flag(keycode);
+    if(!flag)
+    {
+        return true;
+    }
+    if(record->event.pressed)
+    {
+        if(!mouse_motion_active())
+        {
+            last_step = timer_read();
+        }
+        held |= flag;
+    }
+    else
+    {
+        held &= ~flag;
+    }
+    return false;
+}
+
+void mouse_motion_task(void)
+{
+    if(!mouse_motion_active())
+    {
+        return;
+    }
+    const uint16_t now     = timer_read();
+    const uint16_t elapsed = TIMER_DIFF_16(now, last_step);
+    if(elapsed == 0)
+    {
+        return;  // At most one step, and one report, per ms.
+    }
+    last_step = now;
+
+    const int8_t dir_x = !!(held & HELD_RIGHT) - !!(held & HELD_LEFT);
+    const int8_t dir_y = !!(held & HELD_DOWN) - !!(held & HELD_UP);
+    int8_t x, y;
+    mouse_curve_step(&curve, dir_x, dir_y, held & HELD_PRECISE, elapsed, &x, &y);
+    if(x == 0 && y == 0)
+    {
+        return;
+    }
+
+    // Keep the buttons held through QMK's mouse keys.
+    report_mouse_t report = mousekey_get_report();
+    report.x              = x;
+    report.y              = y;
+    report.v              = 0;
+    report.h              = 0;
+    host_mouse_send(&report);
+}
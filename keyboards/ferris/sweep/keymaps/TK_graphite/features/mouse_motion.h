@@ -0,0 +1,23 @@
+#pragma once
+
+#include "quantum.h"
+#include "mouse_curve.h"
+
+/**
+ * Mouse key motion driven by the curve in mouse_curve.h.
+ *
+ * Takes over the stock cursor keycodes (KC_MS_U, KC_MS_D, KC_MS_L, KC_MS_R)
+ * and uses KC_MS_ACCEL0 as a held precision key. Buttons and the wheel are
+ * left to QMK's mouse keys. While the pointer moves, `mouse_motion_task()`
+ * steps the curve every ms and sends a report when it moved a whole pixel;
+ * when idle it sends nothing.
+ */
+
+/** Handler, call from `process_record_user()`. Returns false for the keys it owns. */
+bool process_mouse_motion(uint16_t keycode, keyrecord_t* record);
+
+/** Returns true while the pointer is moving or gliding. */
+bool mouse_motion_active(void);
+
+/** Call from `housekeeping_task_user()`. */
+void mouse_motion_task(void);
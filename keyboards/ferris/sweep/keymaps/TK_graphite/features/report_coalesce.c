@@ -0,0 +1,102 @@
+#include "report_coalesce.h"
+#include "host.h"
+
+enum
+{
+    RUN_NONE,
+    RUN_PRESS,
+    RUN_RELEASE,
+};
+
+// QMK's driver, and the copy installed in its place.
+static host_driver_t* host_driver = NULL;
+static host_driver_t driver;
+static bool batching = false;
+// Last report the host got, and the last report of the run held back.
+static report_keyboard_t sent;
+static report_keyboard_t pending;
+static uint8_t run = RUN_NONE;
+
+// Number of keys of `report` missing from `other`.
+static uint8_t keys_missing(const report_keyboard_t* report, const report_keyboard_t* other)
+{
+    uint8_t count = 0;
+    for(uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; ++i)
+    {
+        if(report->keys[i] && !memchr(other->keys, report->keys[i], KEYBOARD_REPORT_KEYS))
+        {
+            ++count;
+        }
+    }
+    return count;
+}
+
+// Returns RUN_NONE for a change that both presses and releases.
+static uint8_t direction(const report_keyboard_t* from, const report_keyboard_t* to)
+{
+    const bool presses  = (to->mods & ~from->mods) || keys_missing(to, from);
+    const bool releases = (from->mods & ~to->mods) || keys_missing(from, to);
+    if(presses == releases)
+    {
+        return RUN_NONE;
+    }
+    return presses ? RUN_PRESS : RUN_RELEASE;
+}
+
+static void send(const report_keyboard_t* report)
+{
+    sent = *report;
+    host_driver->send_keyboard(&sent);
+}
+
+static void send_keyboard(report_keyboard_t* report)
+{
+    if(!batching)
+    {
+        send(report);
+        return;
+    }
+    if(run != RUN_NONE)
+    {
+        const uint8_t key_edges = keys_missing(report, &sent) + keys_missing(&sent, report);
+        if(direction(&pending, report) == run && key_edges <= 1)
+        {
+            pending = *report;
+            return;
+        }
+        send(&pending);
+    }
+    run = direction(&sent, report);
+    if(run == RUN_NONE)
+    {
+        send(report);
+    }
+    else
+    {
+        pending = *report;
+    }
+}
+
+void report_coalesce_begin(void)
+{
+    host_driver_t* current = host_get_driver();
+    if(current && current != &driver)
+    {
+        // QMK sets its driver after keyboard_post_init_user(), or replaced it.
+        host_driver          = current;
+        driver               = *current;
+        driver.send_keyboard = send_keyboard;
+        host_set_driver(&driver);
+    }
+    batching = true;
+}
+
+void report_coalesce_end(void)
+{
+    if(run != RUN_NONE)
+    {
+        send(&pending);
+        run = RUN_NONE;
+    }
+    batching = false;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "quantum.h"
+
+/**
+ * Merges the keyboard reports of one pass of the main loop.
+ *
+ * QMK sends a report for every mod and key edge: `tap_code16(LCTL(KC_C))`
+ * is Ctrl, Ctrl+C, Ctrl, nothing. Between `report_coalesce_begin()` and
+ * `report_coalesce_end()` the reports are held back, and a run of them that
+ * only presses, or only releases, is sent as its last report: Ctrl+C,
+ * nothing. The order the host sees is kept:
+ *
+ *  * A run changes at most one key besides the mods, keys pressed or
+ *    released together would lose their order. Hosts apply the mods of a
+ *    report before its keys, so mods merge freely with the key.
+ *  * A press after a release, or a release after a press, starts a new
+ *    run, so taps, including taps of a lone mod, are all sent.
+ *
+ * The reports are intercepted by wrapping the `send_keyboard` of QMK's host
+ * driver, installed by the first `report_coalesce_begin()` once USB is up.
+ * NKRO reports are not merged.
+ */
+
+/** Holds reports back. Call in `matrix_scan_user()`, before anything that sends. */
+void report_coalesce_begin(void);
+
+/** Sends the report held back, if any. Call first in `housekeeping_task_user()`. */
+void report_coalesce_end(void);
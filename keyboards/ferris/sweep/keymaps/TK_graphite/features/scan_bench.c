@@ -0,0 +1,110 @@
+#include "scan_bench.h"
+#include "idle_scheduler.h"
+
+typedef struct
+{
+    uint32_t total_us;
+    uint16_t max_us;
+    uint16_t scans;
+} layer_bench_t;
+
+static uint32_t boot_us;
+static uint32_t scan_start_us;
+static uint32_t last_loop_us;
+static uint32_t loop_total_us;
+static uint16_t loop_min_us;
+static uint16_t loop_max_us;
+static uint32_t loops;
+static uint32_t report_timer;
+// Layer on top when the current scan's first key event was dispatched.
+static int8_t scan_layer = -1;
+static layer_bench_t layers[MAX_LAYER];
+
+static uint32_t now_us(void)
+{
+#ifdef TIMER_BASE
+    return TIMER->TIMERAWL;  // RP2040 1 MHz timer.
+#else
+#error "scan_bench needs the RP2040's 1 MHz timer, millisecond timer_read32() is too coarse"
+#endif
+}
+
+static void reset(void)
+{
+    loop_total_us = 0;
+    loop_min_us   = UINT16_MAX;
+    loop_max_us   = 0;
+    loops         = 0;
+    memset(layers, 0, sizeof(layers));
+}
+
+static void report(void)
+{
+    uprintf("bench boot_us %lu loop_us %u %lu %u loops %lu\n",
+            boot_us,
+            loops ? loop_min_us : 0,
+            loops ? loop_total_us / loops : 0,
+            loop_max_us,
+            loops);
+    for(uint8_t i = 0; i < MAX_LAYER; ++i)
+    {
+        if(layers[i].scans)
+        {
+            uprintf("bench layer %u scans %u us %lu %u\n", i, layers[i].scans, layers[i].total_us / layers[i].scans, layers[i].max_us);
+        }
+    }
+    uprintf("bench idle_wake_bound_ms %u\n", idle_scheduler_wake_bound());
+}
+
+void scan_bench_init(void)
+{
+    boot_us      = now_us();
+    last_loop_us = boot_us;
+    report_timer = timer_read32();
+    reset();
+}
+
+void scan_bench_scan_start(void)
+{
+    scan_start_us = now_us();
+    scan_layer    = -1;
+}
+
+void pre_process_scan_bench(uint16_t keycode, keyrecord_t* record)
+{
+    if(scan_layer < 0)
+    {
+        scan_layer = get_highest_layer(layer_state | default_layer_state);
+    }
+}
+
+void scan_bench_task(void)
+{
+    const uint32_t now = now_us();
+
+    const uint32_t loop_us = now - last_loop_us;
+    last_loop_us           = now;
+    loop_total_us += loop_us;
+    loop_min_us = MIN(loop_min_us, MIN(loop_us, UINT16_MAX));
+    loop_max_us = MAX(loop_max_us, MIN(loop_us, UINT16_MAX));
+    ++loops;
+
+    if(scan_layer >= 0)
+    {
+        layer_bench_t* layer = &layers[scan_layer];
+        const uint32_t cost  = now - scan_start_us;
+        layer->total_us += cost;
+        layer->max_us = MAX(layer->max_us, MIN(cost, UINT16_MAX));
+        ++layer->scans;
+        scan_layer = -1;
+    }
+
+    if(timer_elapsed32(report_timer) >= SCAN_BENCH_INTERVAL)
+    {
+        report_timer = timer_read32();
+        report();
+        reset();
+        // Leave the printing out of the next loop period.
+        last_loop_us = now_us();
+    }
+}
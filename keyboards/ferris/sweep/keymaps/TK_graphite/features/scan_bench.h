@@ -0,0 +1,49 @@
+#pragma once
+
+#include "quantum.h"
+
+/**
+ * Scan bench, an on-device tool timing the scan loop and key event handling.
+ *
+ * Build with `SCAN_BENCH_ENABLE=yes`. Times come from the RP2040's 1 MHz
+ * timer, which runs from reset, so they include flash XIP stalls and
+ * interrupts. Every SCAN_BENCH_INTERVAL ms the master prints to the console
+ *
+ *     bench boot_us <us> loop_us <min> <avg> <max> loops <n>
+ *     bench layer <layer> scans <n> us <avg> <max>
+ *     bench idle_wake_bound_ms <max>
+ *
+ * `boot_us` is the time from reset to the end of `keyboard_post_init_user()`.
+ * `loop_us` is the period of the main loop. Each `layer` line covers the
+ * scans that dispatched key events while that layer was on top, timed from
+ * the matrix scan to the end of the keyboard task, reports included.
+ * `idle_wake_bound_ms` is the longest time a press could have waited to be
+ * scanned in the idle scheduler's slow stage, see `idle_scheduler_wake_bound()`.
+ *
+ * The idle scheduler slows the loop down when idle, type while capturing.
+ * scan_bench.py compares a captured log with a baseline saved from an
+ * earlier capture.
+ *
+ * It is a tool for a board on the desk, not a benchmark suite: nothing runs
+ * the firmware image in an emulator, injects scripted matrix states or
+ * tracks a committed baseline. The numbers come from hand typing on the
+ * keyboard flashed, so only compare captures of the same script on the
+ * same board. Regressions on the host are caught by the golden traces and
+ * the latency tests under tests/.
+ */
+
+#ifndef SCAN_BENCH_INTERVAL
+#define SCAN_BENCH_INTERVAL 10000
+#endif
+
+/** Call at the end of `keyboard_post_init_user()`. */
+void scan_bench_init(void);
+
+/** Call first in `matrix_scan_user()`. */
+void scan_bench_scan_start(void);
+
+/** Call from `pre_process_record_user()`, never consumes the event. */
+void pre_process_scan_bench(uint16_t keycode, keyrecord_t* record);
+
+/** Call in `housekeeping_task_user()`, right after `report_coalesce_end()`. */
+void scan_bench_task(void);
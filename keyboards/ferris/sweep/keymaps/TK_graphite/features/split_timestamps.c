@@ -0,0 +1,150 @@
+#include "split_timestamps.h"
+#include "atomic_util.h"
+#include "transactions.h"
+
+#define ROWS_PER_HAND (MATRIX_ROWS / 2)
+
+typedef struct __attribute__((packed))
+{
+    // Row within the half times MATRIX_COLS plus column, top bit set on press.
+    uint8_t key;
+    uint16_t time;
+} split_timestamp_t;
+
+typedef struct __attribute__((packed))
+{
+    uint8_t count;
+    split_timestamp_t changes[SPLIT_TIMESTAMPS_MAX];
+} split_timestamps_msg_t;
+
+_Static_assert(sizeof(split_timestamps_msg_t) <= RPC_S2M_BUFFER_SIZE, "SPLIT_TIMESTAMPS_MAX doesn't fit the RPC buffer");
+_Static_assert(ROWS_PER_HAND * MATRIX_COLS <= 0x80, "Key index doesn't fit 7 bits");
+
+#define PRESSED 0x80
+
+// Slave: changes not fetched yet. Master: copy of the slave half's rows.
+static split_timestamps_msg_t pending;
+static matrix_row_t previous[ROWS_PER_HAND];
+// Master: last received change of each slave key, 0 once used.
+static uint16_t key_times[ROWS_PER_HAND * MATRIX_COLS];
+static bool key_pressed[ROWS_PER_HAND * MATRIX_COLS];
+// Master: time of the last key event passed on, 0 before the first.
+static uint16_t last_time;
+
+static uint8_t slave_offset(void)
+{
+    // Rows of the half that isn't this one on the master, this one on the slave.
+    return (is_keyboard_left() == is_keyboard_master()) ? ROWS_PER_HAND : 0;
+}
+
+// Runs from the transport, which the main loop can't preempt: it only has to
+// be kept out of the slave scan's changes to `pending`.
+static void slave_handler(uint8_t in_len, const void* in_data, uint8_t out_len, void* out_data)
+{
+    memcpy(out_data, &pending, sizeof(pending));
+    pending.count = 0;
+}
+
+void split_timestamps_init(void)
+{
+    transaction_register_rpc(SPLIT_TIMESTAMPS_SYNC, slave_handler);
+}
+
+void split_timestamps_slave_scan(void)
+{
+    const uint8_t offset = slave_offset();
+    const uint16_t now   = sync_timer_read() | 1;
+    for(uint8_t row = 0; row < ROWS_PER_HAND; ++row)
+    {
+        const matrix_row_t current = matrix_get_row(offset + row);
+        const matrix_row_t changed = current ^ previous[row];
+        previous[row]              = current;
+        for(uint8_t col = 0; changed && col < MATRIX_COLS; ++col)
+        {
+            if(!(changed & ((matrix_row_t)1 << col)))
+            {
+                continue;
+            }
+            const bool pressed = current & ((matrix_row_t)1 << col);
+            ATOMIC_BLOCK_FORCEON
+            {
+                if(pending.count == SPLIT_TIMESTAMPS_MAX)
+                {
+                    // Not fetched in time, drop the oldest.
+                    memmove(&pending.changes[0], &pending.changes[1], sizeof(split_timestamp_t) * (SPLIT_TIMESTAMPS_MAX - 1));
+                    --pending.count;
+                }
+                pending.changes[pending.count++] = (split_timestamp_t){(row * MATRIX_COLS + col) | (pressed ? PRESSED : 0), now};
+            }
+        }
+    }
+}
+
+void split_timestamps_master_scan(void)
+{
+    const uint8_t offset = slave_offset();
+    bool changed         = false;
+    for(uint8_t row = 0; row < ROWS_PER_HAND; ++row)
+    {
+        const matrix_row_t current = matrix_get_row(offset + row);
+        changed |= current != previous[row];
+        previous[row] = current;
+    }
+    if(!changed)
+    {
+        return;  // Nothing to fetch, no transaction.
+    }
+
+    split_timestamps_msg_t msg = {0};
+    if(!transaction_rpc_recv(SPLIT_TIMESTAMPS_SYNC, sizeof(msg), &msg))
+    {
+        return;
+    }
+    for(uint8_t i = 0; i < msg.count && i < SPLIT_TIMESTAMPS_MAX; ++i)
+    {
+        const uint8_t key = msg.changes[i].key & ~PRESSED;
+        if(key < ROWS_PER_HAND * MATRIX_COLS)
+        {
+            key_times[key]   = msg.changes[i].time;
+            key_pressed[key] = msg.changes[i].key & PRESSED;
+        }
+    }
+}
+
+// Moves the event of a slave key back to its logged time. Never before the
+// last event passed on: tap-hold and combos compare times by subtracting
+// them, an earlier time would wrap around. Every key event goes through here
+// before them, so that covers a pending tap-hold key too.
+static void restamp(keyrecord_t* record, uint8_t key)
+{
+    uint16_t time = key_times[key];
+    if(time == 0 || key_pressed[key] != record->event.pressed)
+    {
+        return;
+    }
+    key_times[key]      = 0;
+    const uint16_t skew = TIMER_DIFF_16(record->event.time, time);
+    if(skew > SPLIT_TIMESTAMPS_MAX_SKEW)
+    {
+        return;
+    }
+    if(last_time && TIMER_DIFF_16(record->event.time, last_time) < skew)
+    {
+        time = last_time;
+    }
+    record->event.time = time;
+}
+
+void pre_process_split_timestamps(uint16_t keycode, keyrecord_t* record)
+{
+    if(!IS_KEYEVENT(record->event))
+    {
+        return;
+    }
+    const uint8_t row = record->event.key.row - slave_offset();
+    if(row < ROWS_PER_HAND)
+    {
+        restamp(record, row * MATRIX_COLS + record->event.key.col);
+    }
+    last_time = record->event.time;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "quantum.h"
+
+/**
+ * True press times for keys of the slave half.
+ *
+ * The master only sees a slave key change when it next reads the slave's
+ * matrix, so `record->event.time` of slave keys is late by up to a transport
+ * cycle. The slave logs each key change of its half with `sync_timer_read()`,
+ * which runs on the master's clock. When the master sees the slave half
+ * change, it fetches only those changes over a split RPC, and
+ * `pre_process_split_timestamps()` rewrites the event time before tap-hold,
+ * combos and Achordion look at it. A time is never moved before the event
+ * passed on ahead of it.
+ *
+ * Events are still processed in the order the master sees them, and that
+ * order isn't corrected: a slave key pressed before a master key, but
+ * fetched after it, is clamped to the master key's time. The two look
+ * pressed at once, a roll of the slave key into the master key can read as
+ * the other way round. Putting them back in order would mean holding every
+ * event back for a sync interval, on both halves, and replaying them from
+ * userspace, which QMK has no hook for.
+ *
+ * Scans may skip `split_timestamps_master_scan()`, e.g. while idle: the
+ * changes are fetched by the next call, the events seen in between keep the
+ * master's time.
+ *
+ * Needs `SPLIT_TRANSACTION_IDS_USER SPLIT_TIMESTAMPS_SYNC` in config.h.
+ */
+
+// Changes sent per fetch, 3 bytes each in the RPC buffer.
+#ifndef SPLIT_TIMESTAMPS_MAX
+#define SPLIT_TIMESTAMPS_MAX 8
+#endif
+
+// Older timestamps are stale, the event keeps the master's time.
+#ifndef SPLIT_TIMESTAMPS_MAX_SKEW
+#define SPLIT_TIMESTAMPS_MAX_SKEW 50
+#endif
+
+/** Registers the RPC handler. Call from `keyboard_post_init_user()`. */
+void split_timestamps_init(void);
+
+/** Logs changes of the slave half. Call from `matrix_slave_scan_user()`. */
+void split_timestamps_slave_scan(void);
+
+/** Fetches the slave's changes if its half changed. Call from `matrix_scan_user()`. */
+void split_timestamps_master_scan(void);
+
+/** Call from `pre_process_record_user()`, never consumes the event. */
+void pre_process_split_timestamps(uint16_t keycode, keyrecord_t* record);
@@ -0,0 +1,149 @@
+#include "text_expansion.h"
+#include "text_expansion_data.h"
+
+// Last typed keys, a KC_SPC marks a word boundary.
+static uint8_t buffer[TEXT_EXPANSION_MAX_LENGTH] = {KC_SPC};
+static uint8_t buffer_size                       = 1;
+
+static void reset_buffer(void)
+{
+    buffer[0]   = KC_SPC;
+    buffer_size = 1;
+}
+
+// Branch entries are the key and a 24-bit offset, low byte first.
+static uint32_t read_offset(uint32_t entry)
+{
+    return pgm_read_byte(text_expansion_data + entry + 1) | (uint32_t)pgm_read_byte(text_expansion_data + entry + 2) << 8 |
+           (uint32_t)pgm_read_byte(text_expansion_data + entry + 3) << 16;
+}
+
+// Walks the trie backwards from the newest key. Returns the offset of the
+// matching leaf, or 0 if there is none.
+static uint32_t find_match(void)
+{
+    uint32_t state = 0;
+    uint8_t code   = pgm_read_byte(text_expansion_data + state);
+    for(int8_t i = buffer_size - 1; i >= 0; --i)
+    {
+        const uint8_t key = buffer[i];
+        if(code & 64)
+        {
+            // Branch node, look for the entry of this key.
+            while(code != (key | 64))
+            {
+                state += 4;
+                code = pgm_read_byte(text_expansion_data + state);
+                if(code == 0)
+                {
+                    return 0;
+                }
+            }
+            state = read_offset(state);
+            code  = pgm_read_byte(text_expansion_data + state);
+        }
+        else if(code != key)
+        {
+            return 0;
+        }
+        else if((code = pgm_read_byte(text_expansion_data + (++state))) == 0)
+        {
+            // End of a chain, the child follows.
+            code = pgm_read_byte(text_expansion_data + (++state));
+        }
+
+        if(code & 128)
+        {
+            return state;
+        }
+    }
+    return 0;
+}
+
+bool process_text_expansion(uint16_t keycode, keyrecord_t* record)
+{
+    if(!record->event.pressed || IS_MODIFIER_KEYCODE(keycode) || IS_QK_ONE_SHOT_MOD(keycode))
+    {
+        return true;
+    }
+    if(!text_expansion_enabled_user() || (get_mods() & ~MOD_MASK_SHIFT) != 0)
+    {
+        reset_buffer();
+        return true;
+    }
+
+    if(IS_QK_MOD_TAP(keycode) || IS_QK_LAYER_TAP(keycode))
+    {
+        if(record->tap.count == 0)
+        {
+            return true;  // Held, acts as a mod or layer.
+        }
+        keycode = IS_QK_MOD_TAP(keycode) ? QK_MOD_TAP_GET_TAP_KEYCODE(keycode) : QK_LAYER_TAP_GET_TAP_KEYCODE(keycode);
+    }
+
+    uint8_t key;
+    switch(keycode)
+    {
+    case KC_A ... KC_Z:
+        key = keycode;
+        break;
+    case KC_SPC:
+    case KC_ENT:
+    case KC_TAB:
+    case KC_DOT:
+    case KC_COMM:
+    case KC_MINS:
+    case KC_SCLN:
+    case KC_SLSH:
+        key = KC_SPC;
+        break;
+    case KC_BSPC:
+        if(buffer_size > 0)
+        {
+            --buffer_size;
+        }
+        return true;
+    default:
+        // Anything else (navigation, macros) loses track of the word.
+        reset_buffer();
+        return true;
+    }
+
+    if(buffer_size >= TEXT_EXPANSION_MAX_LENGTH)
+    {
+        memmove(buffer, buffer + 1, TEXT_EXPANSION_MAX_LENGTH - 1);
+        buffer_size = TEXT_EXPANSION_MAX_LENGTH - 1;
+    }
+    buffer[buffer_size++] = key;
+    if(buffer_size < TEXT_EXPANSION_MIN_LENGTH)
+    {
+        return true;
+    }
+
+    const uint32_t state = find_match();
+    if(state == 0)
+    {
+        return true;
+    }
+
+    const uint8_t code = pgm_read_byte(text_expansion_data + state);
+    for(uint8_t i = 0; i < (code & 63); ++i)
+    {
+        tap_code(KC_BSPC);
+    }
+    send_string_P((const char*)(text_expansion_data + state + 1));
+    if(code & 64)
+    {
+        // The match ended on a word boundary. Let the boundary key through
+        // so it is typed after the replacement with its key overrides.
+        reset_buffer();
+        return true;
+    }
+    buffer_size = 0;
+    return false;
+}
+
+__attribute__((weak)) bool text_expansion_enabled_user(void)
+{
+    return true;
+}
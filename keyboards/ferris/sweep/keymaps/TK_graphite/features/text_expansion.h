@@ -0,0 +1,23 @@
+#pragma once
+
+#include "quantum.h"
+
+/**
+ * Typo correction and abbreviation expansion.
+ *
+ * The dictionary lives in text_expansion_dict.txt and is compiled offline by
+ * make_text_expansion_data.py into a flat trie in flash
+ * (text_expansion_data.h). Typed letters are kept in a small rolling buffer
+ * and each key press walks the trie backwards from the newest key, so a
+ * keystroke costs at most one step per key of the longest entry.
+ *
+ * On a match, the needed backspaces and the rest of the replacement text are
+ * sent. The key that completed it is swallowed, unless it is the word
+ * boundary, which then continues through `process_record()` as usual.
+ */
+
+/** Handler, call from `process_record_user()`. Returns false if the key was replaced. */
+bool process_text_expansion(uint16_t keycode, keyrecord_t* record);
+
+/** Optional callback, return false to pause matching, e.g. off the alpha layer. */
+bool text_expansion_enabled_user(void);
@@ -0,0 +1,215 @@
+#include "thumb_layer.h"
+#include "keycode_event.h"
+
+enum
+{
+    THUMB_RELEASED,
+    THUMB_UNSETTLED,
+    THUMB_HOLDING,
+    THUMB_TAPPED,
+};
+
+static uint8_t states[THUMB_LAYER_MAX];
+static keyrecord_t press_records[THUMB_LAYER_MAX];
+// Press of another key while a thumb key is unsettled, held back until a
+// release tells tap from hold.
+static keyrecord_t buffered_record;
+static bool has_buffered_record = false;
+// Set while events are sent through `process_record()` again.
+static bool dispatching = false;
+// Last key press, to tell whether the next thumb press is mid-word.
+static uint16_t last_press_time = 0;
+static bool last_press_typing   = false;
+
+static uint8_t thumb_count(void)
+{
+    return thumb_layers_count < THUMB_LAYER_MAX ? thumb_layers_count : THUMB_LAYER_MAX;
+}
+
+static int8_t thumb_index(uint16_t keycode)
+{
+    for(uint8_t i = 0; i < thumb_count(); ++i)
+    {
+        if(thumb_layers[i].keycode == keycode)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// At most one thumb key is unsettled, a second one settles the first.
+static int8_t unsettled(void)
+{
+    for(uint8_t i = 0; i < thumb_count(); ++i)
+    {
+        if(states[i] == THUMB_UNSETTLED)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static bool any_holding(void)
+{
+    for(uint8_t i = 0; i < thumb_count(); ++i)
+    {
+        if(states[i] == THUMB_HOLDING)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Sends `record` through the whole pipeline again. Its keycode is looked up
+// again, on the layers now on.
+static void dispatch(keyrecord_t* record)
+{
+    dispatching = true;
+    process_record(record);
+    dispatching = false;
+}
+
+// Settles the unsettled thumb key `i` and sends the press held back, if any,
+// after the layer is on for a hold or after the tap.
+static void settle(uint8_t i, bool hold)
+{
+    dprintf("Thumb: 0x%04X settled as %s.\n", thumb_layers[i].keycode, hold ? "hold" : "tap");
+    if(hold)
+    {
+        layer_on(thumb_layers[i].layer);
+        states[i]         = THUMB_HOLDING;
+        last_press_typing = false;
+    }
+    else
+    {
+        dispatching = true;
+        keycode_tap(thumb_layers[i].tap);
+        dispatching = false;
+        states[i]   = THUMB_TAPPED;
+    }
+    if(has_buffered_record)
+    {
+        has_buffered_record = false;
+        dispatch(&buffered_record);
+    }
+}
+
+static bool process_thumb(uint8_t i, keyrecord_t* record)
+{
+    if(record->event.pressed)
+    {
+        // Two thumb keys pressed together, the first one is held.
+        const int8_t other = unsettled();
+        if(other >= 0)
+        {
+            settle(other, true);
+        }
+        press_records[i] = *record;
+        states[i]        = THUMB_UNSETTLED;
+        if(last_press_typing && TIMER_DIFF_16(record->event.time, last_press_time) < THUMB_LAYER_STREAK_TERM)
+        {
+            settle(i, false);
+        }
+        return false;
+    }
+
+    if(states[i] == THUMB_UNSETTLED)
+    {
+        if(has_buffered_record)
+        {
+            // Released before the key held back: a roll, unless both were
+            // down together long enough for a chord.
+            settle(i, TIMER_DIFF_16(record->event.time, buffered_record.event.time) >= THUMB_LAYER_OVERLAP);
+        }
+        else if(TIMER_DIFF_16(record->event.time, press_records[i].event.time) < THUMB_LAYER_TAP_TERM)
+        {
+            settle(i, false);
+        }
+    }
+    if(states[i] == THUMB_HOLDING)
+    {
+        layer_off(thumb_layers[i].layer);
+    }
+    states[i] = THUMB_RELEASED;
+    return false;
+}
+
+// Decides an unsettled thumb key on the press of another key. Returns false
+// when the press was held back or already sent again.
+static bool process_other_press(uint8_t i, uint16_t keycode, keyrecord_t* record)
+{
+    if(has_buffered_record)
+    {
+        // A third key, chording.
+        settle(i, true);
+        dispatch(record);
+        return false;
+    }
+    if(!thumb_layer_chord_user(&thumb_layers[i], &press_records[i], keycode, record))
+    {
+        settle(i, false);
+        return true;
+    }
+    const bool held_tap_hold = (IS_QK_MOD_TAP(keycode) || IS_QK_LAYER_TAP(keycode)) && record->tap.count == 0;
+    if(held_tap_hold || TIMER_DIFF_16(record->event.time, press_records[i].event.time) >= THUMB_LAYER_TAP_TERM)
+    {
+        settle(i, true);
+        dispatch(record);
+        return false;
+    }
+    buffered_record     = *record;
+    has_buffered_record = true;
+    return false;
+}
+
+bool process_thumb_layer(uint16_t keycode, keyrecord_t* record)
+{
+    if(dispatching)
+    {
+        return true;
+    }
+    const int8_t thumb = thumb_index(keycode);
+    if(thumb >= 0)
+    {
+        return process_thumb(thumb, record);
+    }
+    if(!IS_KEYEVENT(record->event))
+    {
+        return true;
+    }
+
+    const int8_t i = unsettled();
+    if(!record->event.pressed)
+    {
+        if(i >= 0 && has_buffered_record && KEYEQ(record->event.key, buffered_record.event.key))
+        {
+            // The other key released first while the thumb key is down.
+            settle(i, true);
+            dispatch(record);
+            return false;
+        }
+        return true;
+    }
+
+    const bool result = i >= 0 ? process_other_press(i, keycode, record) : true;
+    last_press_time   = record->event.time;
+    last_press_typing = !any_holding();
+    return result;
+}
+
+void thumb_layer_task(void)
+{
+    const int8_t i = unsettled();
+    if(i >= 0 && has_buffered_record && timer_elapsed(buffered_record.event.time) >= THUMB_LAYER_OVERLAP)
+    {
+        settle(i, true);
+    }
+}
+
+__attribute__((weak)) bool thumb_layer_chord_user(const thumb_layer_t* thumb, keyrecord_t* thumb_record, uint16_t other_keycode, keyrecord_t* other_record)
+{
+    return true;
+}
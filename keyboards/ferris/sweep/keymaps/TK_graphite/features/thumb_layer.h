@@ -0,0 +1,80 @@
+#pragma once
+
+#include "quantum.h"
+
+/**
+ * Layer-tap keys for the thumbs, decided at the first informative event
+ * instead of after a tapping term.
+ *
+ * While a thumb key is down and unsettled:
+ *
+ *  * The next key press goes to `thumb_layer_chord_user()`. If it returns
+ *    false, the tap is sent and the key goes on as usual. Otherwise the
+ *    press is held back until the first of:
+ *     * the other key released: a hold,
+ *     * both keys down together for THUMB_LAYER_OVERLAP: a hold,
+ *     * the thumb key released: a roll, the tap is sent first.
+ *    Like Achordion's ACHORDION_RELEASE_OVERLAP, a chord is told from a roll
+ *    by the overlap, not by a tapping term.
+ *  * A third key, a held mod-tap or layer-tap, or a key pressed after the
+ *    thumb key was held alone for THUMB_LAYER_TAP_TERM settles it as held.
+ *  * Released before THUMB_LAYER_TAP_TERM without another key, it's a tap.
+ *  * Pressed within THUMB_LAYER_STREAK_TERM of a key typed outside of a
+ *    thumb layer, the tap is sent on press: mid-word it's always a tap.
+ *
+ * For a hold the layer is turned on and the held back events are sent
+ * through `process_record()` again, like Achordion does, so their keycodes
+ * are looked up on the layer. The layer is only turned on once it's needed,
+ * so a tap never flashes the layer indicator. Taps are sent with
+ * `keycode_tap()`, so features like text expansion see them and layer keys
+ * such as TO() work.
+ *
+ * Define the keys in keymap.c:
+ *
+ *     const thumb_layer_t thumb_layers[] = {
+ *         {NAV_HOLD, KC_SPC, NAV_LAYER},
+ *     };
+ *     const uint8_t thumb_layers_count = ARRAY_SIZE(thumb_layers);
+ *
+ * and call `process_thumb_layer()` from `process_record_user()` and
+ * `thumb_layer_task()` from `matrix_scan_user()`.
+ */
+
+#ifndef THUMB_LAYER_MAX
+#define THUMB_LAYER_MAX 4
+#endif
+
+#ifndef THUMB_LAYER_TAP_TERM
+#define THUMB_LAYER_TAP_TERM TAPPING_TERM
+#endif
+
+// Achordion's default ACHORDION_RELEASE_OVERLAP.
+#ifndef THUMB_LAYER_OVERLAP
+#define THUMB_LAYER_OVERLAP 80
+#endif
+
+#ifndef THUMB_LAYER_STREAK_TERM
+#define THUMB_LAYER_STREAK_TERM 100
+#endif
+
+typedef struct
+{
+    // Custom keycode of the thumb key.
+    uint16_t keycode;
+    // Keycode tapped.
+    uint16_t tap;
+    // Layer on while held.
+    uint8_t layer;
+} thumb_layer_t;
+
+extern const thumb_layer_t thumb_layers[];
+extern const uint8_t thumb_layers_count;
+
+/** Handler, call from `process_record_user()`. Returns false for thumb keys and presses held back. */
+bool process_thumb_layer(uint16_t keycode, keyrecord_t* record);
+
+/** Settles a thumb key held together with the press held back for THUMB_LAYER_OVERLAP. Call from `matrix_scan_user()`. */
+void thumb_layer_task(void);
+
+/** Optional callback, return false to tap `thumb` when `other_keycode` is pressed, true to let the release order decide. */
+bool thumb_layer_chord_user(const thumb_layer_t* thumb, keyrecord_t* thumb_record, uint16_t other_keycode, keyrecord_t* other_record);
@@ -0,0 +1,73 @@
+#include "typing_speed.h"
+
+static uint16_t intervals[TYPING_SPEED_WINDOW];
+static uint16_t sum        = 0;
+static uint8_t next        = 0;
+static uint8_t count       = 0;
+static uint16_t last_press = 0;
+static bool has_pressed    = false;
+
+static void clear_window(void)
+{
+    memset(intervals, 0, sizeof(intervals));
+    sum   = 0;
+    next  = 0;
+    count = 0;
+}
+
+void pre_process_typing_speed(uint16_t keycode, keyrecord_t* record)
+{
+    if(!IS_KEYEVENT(record->event) || !record->event.pressed)
+    {
+        return;
+    }
+
+    uint16_t time = record->event.time;
+    if(has_pressed && !timer_expired(time, last_press))
+    {
+        // Restamped earlier than the last press, both came down together.
+        time = last_press;
+    }
+    const uint16_t gap = TIMER_DIFF_16(time, last_press);
+    if(has_pressed && gap <= TYPING_SPEED_MAX_GAP)
+    {
+        sum -= intervals[next];
+        intervals[next] = gap;
+        sum += gap;
+        next = (next + 1) % TYPING_SPEED_WINDOW;
+        if(count < TYPING_SPEED_WINDOW)
+        {
+            ++count;
+        }
+    }
+    else
+    {
+        clear_window();  // A pause starts a new burst.
+    }
+    last_press  = time;
+    has_pressed = true;
+}
+
+uint16_t typing_speed_interval(void)
+{
+    // QMK stamps events `timer_read() | 1`, the last press can be 1 ms ahead.
+    const uint16_t now = timer_read();
+    if(count < TYPING_SPEED_MIN_SAMPLES || (timer_expired(now, last_press) && TIMER_DIFF_16(now, last_press) > TYPING_SPEED_MAX_GAP))
+    {
+        return 0;
+    }
+    // Simultaneous presses can make the sum 0, report the fastest interval.
+    return MAX(sum / count, 1);
+}
+
+uint16_t typing_speed_wpm(void)
+{
+    const uint16_t interval = typing_speed_interval();
+    // 60000 ms per minute over 5 keys per word.
+    return interval ? 12000 / interval : 0;
+}
+
+void typing_speed_dump(void)
+{
+    uprintf("typing_speed interval_ms %u wpm %u samples %u\n", typing_speed_interval(), typing_speed_wpm(), count);
+}
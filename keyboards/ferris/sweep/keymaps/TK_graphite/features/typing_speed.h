@@ -0,0 +1,42 @@
+#pragma once
+
+#include "quantum.h"
+
+/**
+ * Typing speed over the last TYPING_SPEED_WINDOW key presses.
+ *
+ * A ring of the intervals between presses and their running sum give the
+ * mean interval in constant time and memory. A pause longer than
+ * TYPING_SPEED_MAX_GAP ends the burst and empties the window. Until
+ * TYPING_SPEED_MIN_SAMPLES intervals are in, and once the last press is
+ * TYPING_SPEED_MAX_GAP old, nobody is typing and the queries return 0.
+ *
+ * Presses are taken from `pre_process_record_user()` so each physical key
+ * counts once, at its event time, before tap-hold and combos delay it.
+ */
+
+#ifndef TYPING_SPEED_WINDOW
+#define TYPING_SPEED_WINDOW 16
+#endif
+
+#ifndef TYPING_SPEED_MAX_GAP
+#define TYPING_SPEED_MAX_GAP 1000
+#endif
+
+#ifndef TYPING_SPEED_MIN_SAMPLES
+#define TYPING_SPEED_MIN_SAMPLES 4
+#endif
+
+_Static_assert(TYPING_SPEED_WINDOW * TYPING_SPEED_MAX_GAP <= UINT16_MAX, "The interval sum must fit in 16 bits");
+
+/** Call from `pre_process_record_user()`, never consumes the event. */
+void pre_process_typing_speed(uint16_t keycode, keyrecord_t* record);
+
+/** Returns the mean interval between key presses in ms, 0 when not typing. */
+uint16_t typing_speed_interval(void);
+
+/** Returns the speed in words per minute of 5 keys, 0 when not typing. */
+uint16_t typing_speed_wpm(void);
+
+/** Prints the current speed to the console. */
+void typing_speed_dump(void);
@@ -0,0 +1,222 @@
+#include "vim_pending.h"
+
+enum
+{
+    VIM_OTHER,
+    VIM_COUNT,
+    VIM_OPERATOR,
+    // Motion whose repeats are collapsed into a count.
+    VIM_MOTION,
+    // Takes a count but is sent as typed, e.g. arrows that are held to repeat.
+    VIM_ACTION,
+};
+
+// Buffered count prefix, 0 if none.
+static uint16_t count              = 0;
+// Buffered operator, KC_NO if none.
+static uint16_t pending_operator   = KC_NO;
+// Motion whose repeats are being collapsed.
+static uint16_t repeat_motion      = KC_NO;
+static uint16_t repeat_count       = 0;
+static deferred_token repeat_token = INVALID_DEFERRED_TOKEN;
+
+static uint8_t classify(uint16_t keycode)
+{
+    switch(keycode)
+    {
+    case KC_KP_1 ... KC_KP_0:
+        return VIM_COUNT;
+    case KC_D:
+    case KC_C:
+    case KC_Y:
+        return VIM_OPERATOR;
+    case KC_W:
+    case KC_B:
+    case KC_E:
+    case KC_LCBR:
+    case KC_RCBR:
+    case LCTL(KC_U):
+    case LCTL(KC_D):
+        return VIM_MOTION;
+    case KC_LEFT:
+    case KC_DOWN:
+    case KC_UP:
+    case KC_RGHT:
+    case KC_DLR:
+    case KC_P:
+    case KC_U:
+    case LCTL(KC_R):
+        return VIM_ACTION;
+    default:
+        return VIM_OTHER;
+    }
+}
+
+// Types `n` on the number row with Shift temporarily lifted.
+static void send_number(uint16_t n)
+{
+    char digits[5];
+    uint8_t len = 0;
+    do
+    {
+        digits[len++] = n % 10;
+        n /= 10;
+    } while(n > 0 && len < sizeof(digits));
+
+    const uint8_t mods = get_mods();
+    del_mods(MOD_MASK_SHIFT);
+    while(len > 0)
+    {
+        const uint8_t digit = digits[--len];
+        tap_code(digit == 0 ? KC_0 : KC_1 + digit - 1);
+    }
+    set_mods(mods);
+}
+
+static void flush_repeats(void)
+{
+    if(repeat_token != INVALID_DEFERRED_TOKEN)
+    {
+        cancel_deferred_exec(repeat_token);
+        repeat_token = INVALID_DEFERRED_TOKEN;
+    }
+    if(repeat_count > 1)
+    {
+        send_number(repeat_count);
+    }
+    if(repeat_count > 0)
+    {
+        tap_code16(repeat_motion);
+    }
+    repeat_motion = KC_NO;
+    repeat_count  = 0;
+}
+
+static uint32_t repeat_callback(uint32_t trigger_time, void* cb_arg)
+{
+    repeat_token = INVALID_DEFERRED_TOKEN;
+    flush_repeats();
+    return 0;
+}
+
+// Sends the buffered count and operator, followed by `keycode` if given.
+static void send_pending(uint16_t keycode)
+{
+    if(count > 0)
+    {
+        send_number(count);
+    }
+    if(pending_operator != KC_NO)
+    {
+        tap_code16(pending_operator);
+    }
+    if(keycode != KC_NO)
+    {
+        tap_code16(keycode);
+    }
+    count            = 0;
+    pending_operator = KC_NO;
+}
+
+void vim_pending_flush(void)
+{
+    flush_repeats();
+    send_pending(KC_NO);
+}
+
+bool process_vim_pending(uint16_t keycode, keyrecord_t* record)
+{
+    // Modifiers are needed to type shifted motions, let them through untouched.
+    // Releases always pass, consumed presses never registered anything.
+    if(IS_MODIFIER_KEYCODE(keycode) || IS_QK_ONE_SHOT_MOD(keycode) || !record->event.pressed)
+    {
+        return true;
+    }
+
+    const uint8_t kind = vim_pending_enabled_user() ? classify(keycode) : VIM_OTHER;
+    if(kind == VIM_OTHER || (get_mods() & ~MOD_MASK_SHIFT) != 0)
+    {
+        vim_pending_flush();
+        return true;
+    }
+    // Shift turns operators into linewise commands (D, C, Y), and arrows are
+    // left registered so holding them auto-repeats.
+    const bool shifted = (get_mods() | get_oneshot_mods()) & MOD_MASK_SHIFT;
+    if((kind == VIM_OPERATOR && shifted) || (kind == VIM_ACTION && count == 0 && pending_operator == KC_NO))
+    {
+        vim_pending_flush();
+        return true;
+    }
+    if(shifted)
+    {
+        keycode = LSFT(keycode);
+        del_oneshot_mods(MOD_MASK_SHIFT);
+    }
+
+    switch(kind)
+    {
+    case VIM_COUNT:
+    {
+        flush_repeats();
+        // Shift was added to the keycode above, the digit is the key's.
+        const uint16_t key  = QK_MODS_GET_BASIC_KEYCODE(keycode);
+        const uint8_t digit = key == KC_KP_0 ? 0 : key - KC_KP_1 + 1;
+        if(count == 0 && digit == 0)
+        {
+            send_pending(KC_0);  // A leading 0 is the motion to the start of the line.
+        }
+        else if(count < 1000)
+        {
+            count = count * 10 + digit;
+        }
+        break;
+    }
+    case VIM_OPERATOR:
+        flush_repeats();
+        if(count == 0 || pending_operator == keycode)
+        {
+            // Without a count there is nothing to batch, and in visual mode
+            // the operator acts right away. A doubled operator acts on the
+            // line, e.g. 3dd.
+            send_pending(keycode);
+        }
+        else
+        {
+            if(pending_operator != KC_NO)
+            {
+                send_pending(KC_NO);
+            }
+            pending_operator = keycode;
+        }
+        break;
+    case VIM_MOTION:
+        if(count > 0 || pending_operator != KC_NO)
+        {
+            flush_repeats();
+            send_pending(keycode);
+        }
+        else if(keycode == repeat_motion)
+        {
+            ++repeat_count;
+            extend_deferred_exec(repeat_token, VIM_PENDING_REPEAT_TERM);
+        }
+        else
+        {
+            flush_repeats();
+            tap_code16(keycode);
+            repeat_motion = keycode;
+            repeat_token  = defer_exec(VIM_PENDING_REPEAT_TERM, repeat_callback, NULL);
+        }
+        break;
+    case VIM_ACTION:
+        flush_repeats();
+        send_pending(keycode);
+        break;
+    }
+    return false;
+}
+
+__attribute__((weak)) bool vim_pending_enabled_user(void)
+{
+    return true;
+}
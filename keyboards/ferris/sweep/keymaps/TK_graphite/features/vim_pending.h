@@ -0,0 +1,38 @@
+#pragma once
+
+#include "quantum.h"
+
+/**
+ * Vim count and operator-pending engine.
+ *
+ * While enabled (see `vim_pending_enabled_user()`), keypad digits are buffered
+ * as a count prefix, and an operator (`d`, `c`, `y`) after a count waits for
+ * its motion. The count, operator and motion are then sent together as one
+ * burst, e.g. `3dw`. An operator without a count is sent right away, so `y`
+ * on a visual selection acts immediately.
+ * Repeated presses of the same word/scroll motion are collapsed: the first
+ * press goes out immediately, the following ones within
+ * `VIM_PENDING_REPEAT_TERM` ms are sent as a single `N<motion>`.
+ *
+ * Any other key flushes what is buffered as it was typed. Call
+ * `vim_pending_flush()` from `layer_state_set_user()` as well, so nothing is
+ * left buffered when the layer is released halfway through a command.
+ *
+ * Requires `DEFERRED_EXEC_ENABLE = yes`.
+ */
+
+#ifndef VIM_PENDING_REPEAT_TERM
+#define VIM_PENDING_REPEAT_TERM 150
+#endif
+
+// Deferred executors scheduled at most at the same time.
+#define VIM_PENDING_DEFERRED_EXECUTORS 1
+
+/** Handler, call from `process_record_user()`. Returns false if the event was consumed. */
+bool process_vim_pending(uint16_t keycode, keyrecord_t* record);
+
+/** Sends everything that is still buffered. */
+void vim_pending_flush(void);
+
+/** Callback deciding whether the engine is active, e.g. on the nav layer. */
+bool vim_pending_enabled_user(void);
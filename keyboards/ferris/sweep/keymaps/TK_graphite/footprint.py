@@ -0,0 +1,174 @@
+#!/usr/bin/env python3
+"""Breaks the firmware's flash and RAM use down by feature from the linker map.
+
+QMK links with -ffunction-sections and -fdata-sections, so the map lists
+every function and variable as its own input section with its object file.
+Each section is assigned to the first feature in RULES whose object and
+section patterns match. Objects under features/ are reported under their
+own name without needing a rule.
+
+.text and .rodata count as flash, .bss and .noinit as RAM, and .data as
+both, since its initial value is copied from flash.
+
+The report is sorted by feature name, one line per feature, so two reports
+can be diffed directly. With --budget, features over their budget are
+listed and the exit code is 1. --write-budget measures a budget instead: the
+usage of every feature and the total, plus --headroom.
+
+Usage (or `make footprint` and `make footprint-budget` from the userspace root):
+  footprint.py [map] [--build-dir DIR] [--budget JSON] [--json]
+  footprint.py [map] [--build-dir DIR] --write-budget JSON [--headroom 0.1]
+"""
+
+import argparse
+import glob
+import json
+import math
+import os
+import re
+import sys
+
+TARGET = "ferris_sweep_TK_graphite"
+
+# (feature, object pattern, section pattern), first match wins.
+RULES = [
+    ("keymap array", r"", r"^\.rodata\.keymaps$"),
+    ("process_record_user", r"", r"^\.text\.process_record_user$"),
+    ("keymap", r"keymap_introspection\.o$|keymap\.o$", r""),
+    ("combos", r"process_combo\.o$", r""),
+    ("key overrides", r"process_key_override\.o$", r""),
+    ("caps word", r"caps_word\.o$", r""),
+    ("mouse keys", r"mousekey\.o$", r""),
+    ("rgblight", r"rgblight[^/]*\.o$|ws2812[^/]*\.o$", r""),
+    ("split", r"/split_common/|serial[^/]*\.o$", r""),
+    ("deferred exec", r"deferred_exec\.o$", r""),
+    ("qmk core", r"/quantum/|/tmk_core/|/platforms/|/drivers/", r""),
+    ("chibios", r"/ChibiOS|/chibios", r""),
+    ("libc", r"lib(c|gcc|m|nosys)[^/]*\.a", r""),
+]
+
+FEATURE_OBJECT = re.compile(r"/features/([^/]+)\.o$")
+
+# Input section, either on one line with its address, size and object, or
+# with the name alone on the line and the rest on the next one.
+SECTION_LINE = re.compile(r"^ (\.\S+|COMMON)(?:\s+(0x[0-9a-f]+)\s+(0x[0-9a-f]+)\s+(.+))?$")
+CONTINUATION = re.compile(r"^\s+(0x[0-9a-f]+)\s+(0x[0-9a-f]+)\s+(.+)$")
+
+
+def memory_of(section):
+    if section.startswith((".text", ".rodata", ".ramtext")):
+        return ("flash",)
+    if section.startswith(".data"):
+        return ("flash", "ram")
+    if section.startswith((".bss", ".noinit")) or section == "COMMON":
+        return ("ram",)
+    return ()
+
+
+def feature_of(obj, section):
+    match = FEATURE_OBJECT.search(obj)
+    if match:
+        return match.group(1)
+    for feature, obj_pattern, section_pattern in RULES:
+        if re.search(obj_pattern, obj) and re.search(section_pattern, section):
+            return feature
+    return "other"
+
+
+def sections(path):
+    with open(path) as f:
+        lines = iter(f.read().split("Linker script and memory map", 1)[-1].splitlines())
+    for line in lines:
+        match = SECTION_LINE.match(line)
+        if not match:
+            continue
+        section, address, size, obj = match.groups()
+        if address is None:
+            match = CONTINUATION.match(next(lines, ""))
+            if not match:
+                continue
+            address, size, obj = match.groups()
+        size = int(size, 16)
+        # Discarded sections are listed at address 0.
+        if size and int(address, 16):
+            yield section, size, obj.strip()
+
+
+def footprint(path):
+    totals = {}
+    for section, size, obj in sections(path):
+        memories = memory_of(section)
+        if not memories:
+            continue
+        usage = totals.setdefault(feature_of(obj, section), {"flash": 0, "ram": 0})
+        for memory in memories:
+            usage[memory] += size
+    return totals
+
+
+def find_map(build_dir):
+    maps = glob.glob(os.path.join(build_dir, TARGET + "*.map"))
+    if not maps:
+        sys.exit(f"no {TARGET}*.map in {build_dir}, build the firmware first")
+    return max(maps, key=os.path.getmtime)
+
+
+def over_budget(totals, budget):
+    total = {m: sum(usage[m] for usage in totals.values()) for m in ("flash", "ram")}
+    failures = []
+    for feature, limits in sorted(budget.items()):
+        usage = total if feature == "total" else totals.get(feature, {"flash": 0, "ram": 0})
+        for memory, limit in sorted(limits.items()):
+            if usage[memory] > limit:
+                failures.append(f"{feature}: {memory} {usage[memory]} > {limit}")
+    return failures
+
+
+def measured_budget(totals, headroom):
+    total = {m: sum(usage[m] for usage in totals.values()) for m in ("flash", "ram")}
+    budget = {}
+    for feature, usage in list(totals.items()) + [("total", total)]:
+        budget[feature] = {m: math.ceil(usage[m] * (1 + headroom)) for m in ("flash", "ram") if usage[m]}
+    return budget
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("map", nargs="?", help="linker map, by default the newest one in --build-dir")
+    parser.add_argument("--build-dir", default=".build")
+    parser.add_argument("--budget", help="JSON of {feature: {\"flash\": bytes, \"ram\": bytes}}")
+    parser.add_argument("--json", action="store_true", help="print JSON instead of a table")
+    parser.add_argument("--write-budget", help="write the measured usage plus --headroom to this JSON")
+    parser.add_argument("--headroom", type=float, default=0.1, help="growth allowed by --write-budget")
+    args = parser.parse_args()
+
+    path = args.map or find_map(args.build_dir)
+    totals = footprint(path)
+
+    if args.json:
+        print(json.dumps(totals, indent=2, sort_keys=True))
+    else:
+        print(f"{'feature':<24}{'flash':>8}{'ram':>8}")
+        for feature in sorted(totals):
+            print(f"{feature:<24}{totals[feature]['flash']:>8}{totals[feature]['ram']:>8}")
+        flash = sum(usage["flash"] for usage in totals.values())
+        ram = sum(usage["ram"] for usage in totals.values())
+        print(f"{'total':<24}{flash:>8}{ram:>8}")
+
+    if args.write_budget:
+        with open(args.write_budget, "w") as f:
+            json.dump(measured_budget(totals, args.headroom), f, indent=2, sort_keys=True)
+            f.write("\n")
+        print(f"budget written to {args.write_budget}")
+
+    if args.budget:
+        with open(args.budget) as f:
+            failures = over_budget(totals, json.load(f))
+        for failure in failures:
+            print("over budget: " + failure, file=sys.stderr)
+        if failures:
+            sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
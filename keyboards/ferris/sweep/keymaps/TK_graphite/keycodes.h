@@ -0,0 +1,74 @@
+#pragma once
+
+#include "quantum.h"
+
+// Layers and custom keycodes, shared by keymap.c and tap_hold.c.
+
+enum Layers
+{
+    ALPHA_LAYER,
+    SYM_LAYER,
+    NUM_LAYER,
+    NAV_LAYER,
+    WIN_NAV_LAYER,
+    FN_LAYER,
+    MEDIA_LAYER,
+    GAMING_LAYER,
+    ACCENT_LAYER,
+    QMK_LAYER
+};
+
+
+enum CustomKeycodes
+{
+    DOT_ARROW = SAFE_RANGE,
+    ARROW,  // Marker of "->" in the key history, not on the keymap.
+    VIM_F,
+    VIM_FF,
+    VIM_T,
+    VIM_TT,
+    COPY,
+    CUT,
+    PASTE,
+    UNDO,
+    REDO,
+    FIND,
+    ESC_ALPHA_LAYER,
+    RUN,
+    ALTTAB,
+    CTLTAB,
+    GUITAB,
+    CTLPGDN,
+
+    WIN_1,
+    WIN_2,
+    WIN_3,
+    WIN_4,
+    WIN_5,
+    WIN_6,
+    WIN_7,
+    WIN_8,
+    WIN_FULL,
+    WIN_MIN,
+    WIN_LEFT,
+    WIN_RIGHT,
+    WIN_SCL,
+    WIN_SCR,
+
+    ACC_E,
+    ACC_A,
+    ACC_I,
+    ACC_O,
+    ACC_U,
+
+    REPEAT,
+    MAGIC,
+    LEADER,
+    COMBO_STATS,
+    MREC,
+    MPLAY,
+    TYPING_SPEED,
+
+    NAV_HOLD,
+    SYM_WIN_LAYER,
+};
@@ -1,66 +1,34 @@
 #include QMK_KEYBOARD_H
+#include "keycodes.h"
 #include "features/achordion.h"
+#ifdef COMBO_STATS_ENABLE
+#include "features/combo_stats.h"
+#endif
+#include "features/compose.h"
+#include "features/exclusive_layer.h"
+#include "features/idle_scheduler.h"
+#include "features/indicator.h"
+#include "features/key_history.h"
+#ifdef KEY_TRACE_ENABLE
+#include "features/key_trace.h"
+#endif
+#include "features/leader_trie.h"
+#include "features/macro_recorder.h"
+#include "features/mod_session.h"
+#include "features/mouse_motion.h"
+#include "features/report_coalesce.h"
+#ifdef SCAN_BENCH_ENABLE
+#include "features/scan_bench.h"
+#endif
+#include "features/split_timestamps.h"
+#include "features/text_expansion.h"
+#include "features/thumb_layer.h"
+#include "features/typing_speed.h"
+#include "features/vim_pending.h"
 #include "keymap_us_international.h"
 #include "sendstring_us_international.h"
 
 
-enum Layers
-{
-    ALPHA_LAYER,
-    SYM_LAYER,
-    NUM_LAYER,
-    NAV_LAYER,
-    WIN_NAV_LAYER,
-    FN_LAYER,
-    MEDIA_LAYER,
-    GAMING_LAYER,
-    ACCENT_LAYER,
-    QMK_LAYER
-};
-
-
-enum CustomKeycodes
-{
-    DOT_ARROW = SAFE_RANGE,
-    VIM_F,
-    VIM_FF,
-    VIM_T,
-    VIM_TT,
-    COPY,
-    CUT,
-    PASTE,
-    UNDO,
-    REDO,
-    FIND,
-    ESC_ALPHA_LAYER,
-    RUN,
-    ALTTAB,
-
-    WIN_1,
-    WIN_2,
-    WIN_3,
-    WIN_4,
-    WIN_5,
-    WIN_6,
-    WIN_7,
-    WIN_8,
-    WIN_FULL,
-    WIN_MIN,
-    WIN_LEFT,
-    WIN_RIGHT,
-    WIN_SCL,
-    WIN_SCR,
-
-    ACC_E,
-    ACC_A,
-    ACC_I,
-    ACC_O,
-    ACC_U,
-};
-
-#define SYM_WIN_LAYER LT(0, KC_1)
-#define NAV_HOLD      LT(NAV_LAYER, KC_SPC)
-
 //////////////////////////////// KEY OVERRIDES ////////////////////////////////
 const key_override_t space_ko         = ko_make_basic(MOD_MASK_SHIFT, NAV_HOLD, KC_TAB);
 const key_override_t vimf_ko          = ko_make_basic(MOD_MASK_SHIFT, VIM_F, VIM_FF);
@@ -77,6 +45,33 @@ const key_override_t* key_overrides[] = {
     &vim_undo_redo_ko,
 };
 
+//////////////////////////////// MOD SESSIONS /////////////////////////////////
+enum ModSessions
+{
+    SESSION_ALT_TAB,
+    SESSION_CTL_TAB,
+    SESSION_GUI_TAB,
+    SESSION_CTL_PGDN,
+};
+
+const mod_session_t mod_sessions[] = {
+    [SESSION_ALT_TAB]  = {ALTTAB, KC_TAB, MOD_BIT(KC_LALT), 1000},
+    [SESSION_CTL_TAB]  = {CTLTAB, KC_TAB, MOD_BIT(KC_LCTL), 1000},
+    [SESSION_GUI_TAB]  = {GUITAB, KC_TAB, MOD_BIT(KC_LGUI), 1000},
+    [SESSION_CTL_PGDN] = {CTLPGDN, KC_PGDN, MOD_BIT(KC_LCTL), 1000},
+};
+const uint8_t mod_sessions_count = ARRAY_SIZE(mod_sessions);
+_Static_assert(ARRAY_SIZE(mod_sessions) <= MOD_SESSION_MAX, "Raise MOD_SESSION_MAX");
+_Static_assert(ARRAY_SIZE(mod_sessions) * MOD_SESSION_DEFERRED_EXECUTORS + VIM_PENDING_DEFERRED_EXECUTORS +
+                       COMPOSE_DEFERRED_EXECUTORS + LEADER_TRIE_DEFERRED_EXECUTORS + MACRO_RECORDER_DEFERRED_EXECUTORS <=
+                   MAX_DEFERRED_EXECUTORS,
+               "Features can schedule more deferred executors than MAX_DEFERRED_EXECUTORS");
+
+void mod_session_changed_user(uint8_t active)
+{
+    indicator_set(INDICATOR_ALT_TAB, active & (1 << SESSION_ALT_TAB));
+}
+
 //////////////////////////////// COMBOS ///////////////////////////////////////
 #ifdef COMB
 #undef COMB
@@ -109,7 +104,10 @@ uint16_t get_combo_term(uint16_t combo_index, combo_t* combo)
         return 50;
     }
 
-    return COMBO_TERM;
+    // Fast rolls overlap briefly, a shorter term keeps them from firing
+    // combos. Deliberate combos aren't pressed any faster, hence the floor.
+    const uint16_t interval = typing_speed_interval();
+    return interval ? MIN(COMBO_TERM, MAX(interval / 3, COMBO_TERM_MIN)) : COMBO_TERM;
 }
 #endif
 
@@ -128,119 +126,270 @@ bool combo_should_trigger(uint16_t combo_index, combo_t* combo, uint16_t keycode
     return true;
 }
 
-//////////////////////////////// TAP-HOLD /////////////////////////////////////
-uint16_t get_tapping_term(uint16_t keycode, keyrecord_t* record)
-{
-    switch(keycode)
-    {
-    case LGUI_T(KC_R):
-    case RGUI_T(KC_E):
-        return TAPPING_TERM + 100;
-    default:
-        return TAPPING_TERM;
-    }
-}
-
-
-//////////////////////////////// ACHORDION ////////////////////////////////////
+//////////////////////////////// THUMB LAYERS /////////////////////////////////
+const thumb_layer_t thumb_layers[] = {
+    {NAV_HOLD, KC_SPC, NAV_LAYER},
+    {SYM_WIN_LAYER, TO(SYM_LAYER), WIN_NAV_LAYER},
+};
+const uint8_t thumb_layers_count = ARRAY_SIZE(thumb_layers);
 
-bool achordion_chord(uint16_t tap_hold_keycode,
-                     keyrecord_t* tap_hold_record,
-                     uint16_t other_keycode,
-                     keyrecord_t* other_record)
+bool thumb_layer_chord_user(const thumb_layer_t* thumb, keyrecord_t* thumb_record, uint16_t other_keycode, keyrecord_t* other_record)
 {
-    if(tap_hold_keycode == SYM_WIN_LAYER)
+    if(thumb->keycode == SYM_WIN_LAYER)
     {
-        // if the other key is on the home row, then consider it a hold (this is where the buttons for switching windows are on WIN_NAV_LAYER)
+        // if the other key is on the home row, then let the release order decide (this is where the buttons for switching windows are on WIN_NAV_LAYER)
         // this avoids having to hold for a long time when switching to windows that have the key on the same side as the layer switch key
         if(other_record->event.key.row % (MATRIX_ROWS / 2) == 1)
         {
             return true;
         }
+        // Otherwise tap to SYM_LAYER when rolling into a symbol with the same hand.
+        return other_keycode == OSM(MOD_LSFT) || achordion_opposite_hands(thumb_record, other_record);
     }
-    if(tap_hold_keycode == NAV_HOLD)
-        return true;
-    if(other_keycode == OSM(MOD_LSFT))
-        return true;
-    return achordion_opposite_hands(tap_hold_record, other_record);
+    return true;
+}
+
+//////////////////////////////// TAP-HOLD /////////////////////////////////////
+// get_tapping_term() and the Achordion callbacks are in tap_hold.c, which the
+// Achordion fuzzer in tests/ builds too.
+
+//////////////////////////////// VIM //////////////////////////////////////////
+bool vim_pending_enabled_user(void)
+{
+    return IS_LAYER_ON(NAV_LAYER);
 }
 
-uint16_t achordion_timeout(uint16_t tap_hold_keycode)
+//////////////////////////////// MAGIC KEY ////////////////////////////////////
+// Same-finger bigrams of the Graphite alpha layer, typed with MAGIC instead.
+const magic_t magic_table[] = {
+    {KC_O, KC_A},  // oa, middle finger
+    {KC_U, KC_E},  // ue, ring finger
+    {KC_E, KC_U},  // eu, ring finger
+    {KC_P, KC_H},  // ph, index finger
+    {KC_S, KC_C},  // sc, index finger
+    {KC_R, KC_L},  // rl, ring finger
+};
+const uint8_t magic_table_count = ARRAY_SIZE(magic_table);
+
+// Types "->" for DOT_ARROW with Shift, and pushes ARROW so REPEAT types both keys.
+static void send_arrow(void)
 {
-    return 800;
+    const uint8_t hold_mods = get_mods();
+    // Temporarily delete shift, without a report of its own.
+    del_oneshot_mods(MOD_MASK_SHIFT);
+    del_mods(MOD_MASK_SHIFT);
+    tap_code(KC_MINS);
+    tap_code16(KC_GT);
+    set_mods(hold_mods);  // Restore mods.
+    send_keyboard_report();
+    key_history_push(ARROW, 0);
 }
 
-bool achordion_eager_mod(uint8_t mod)
+void key_history_replay_user(uint16_t keycode)
 {
-    switch(mod)
+    if(keycode == ARROW)
     {
-    case MOD_LSFT:
-    case MOD_RSFT:
-    case MOD_LCTL:
-    case MOD_RCTL:
-        return true;  // Eagerly apply Shift and Ctrl mods.
+        send_arrow();
+    }
+}
+
+//////////////////////////////// ACCENTS //////////////////////////////////////
+// Accented letters that US International types with a single AltGr chord
+// instead of dead key + letter.
+const compose_t compose_table[] = {
+    {KC_QUOT, KC_A, {US_AACU}},
+    {KC_QUOT, KC_E, {US_EACU}},
+    {KC_QUOT, KC_I, {US_IACU}},
+    {KC_QUOT, KC_O, {US_OACU}},
+    {KC_QUOT, KC_U, {US_UACU}},
+    {KC_DQUO, KC_A, {US_ADIA}},
+    {KC_DQUO, KC_O, {US_ODIA}},
+    {KC_DQUO, KC_U, {US_UDIA}},
+};
+const uint8_t compose_table_count = ARRAY_SIZE(compose_table);
+
+bool compose_layer_user(void)
+{
+    return layer_state_is(ACCENT_LAYER);
+}
 
+uint16_t compose_base_user(uint16_t keycode)
+{
+    switch(keycode)
+    {
+    case ACC_E:
+        return KC_E;
+    case ACC_A:
+        return KC_A;
+    case ACC_I:
+        return KC_I;
+    case ACC_O:
+        return KC_O;
+    case ACC_U:
+        return KC_U;
     default:
-        return false;
+        return KC_NO;
     }
 }
-uint16_t achordion_streak_timeout(uint16_t tap_hold_keycode)
+
+//////////////////////////////// LEADER ///////////////////////////////////////
+// Sequences are declared in leader.def, run make_leader_data.py after editing it.
+#include "leader_data.h"
+
+//////////////////////////////// MACRO RECORDER ///////////////////////////////
+bool macro_recorder_skip_user(uint16_t keycode)
+{
+    // The leader key would swallow the recorded action that follows it.
+    return keycode == MREC || keycode == MPLAY || keycode == LEADER;
+}
+
+//////////////////////////////// TEXT EXPANSION ///////////////////////////////
+bool text_expansion_enabled_user(void)
 {
-    if(IS_QK_LAYER_TAP(tap_hold_keycode))
+    return exclusive_layer_get() == ALPHA_LAYER;
+}
+
+//////////////////////////////// SHORTCUTS ////////////////////////////////////
+// Custom keycodes that tap a single shortcut. The report coalescer sends the
+// mods with the key, 2 reports instead of tap_code16()'s 4.
+static uint16_t shortcut_for(uint16_t keycode)
+{
+    switch(keycode)
     {
-        return 0;  // Disable streak detection on layer-tap keys.
+    case COPY:
+        return LCTL(KC_C);
+    case CUT:
+        return LCTL(KC_X);
+    case PASTE:
+        return LCTL(KC_V);
+    case UNDO:
+        return LCTL(KC_Z);
+    case REDO:
+        return LCTL(KC_Y);
+    case FIND:
+        return LCTL(KC_F);
+    case RUN:
+        return HYPR(KC_SPC);
+    case WIN_1:
+        return LGUI(KC_1);
+    case WIN_2:
+        return LGUI(KC_2);
+    case WIN_3:
+        return LGUI(KC_3);
+    case WIN_4:
+        return LGUI(KC_4);
+    case WIN_5:
+        return LGUI(KC_5);
+    case WIN_6:
+        return LGUI(KC_6);
+    case WIN_7:
+        return LGUI(KC_7);
+    case WIN_8:
+        return LGUI(KC_8);
+    case WIN_FULL:
+        return LGUI(KC_UP);
+    case WIN_MIN:
+        return LGUI(KC_DOWN);
+    case WIN_LEFT:
+        return LGUI(KC_LEFT);
+    case WIN_RIGHT:
+        return LGUI(KC_RGHT);
+    case WIN_SCL:
+        return LSG(KC_LEFT);
+    case WIN_SCR:
+        return LSG(KC_RGHT);
+    default:
+        return KC_NO;
     }
-
-    // Otherwise, tap_hold_keycode is a mod-tap key.
-    return 100;  // default
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-bool is_alt_tab_active = false;  // ADD this near the beginning of keymap.c
-uint16_t alt_tab_timer = 0;      // we will be using them soon.
-                                 //
+bool pre_process_record_user(uint16_t keycode, keyrecord_t* record)
+{
+    pre_process_split_timestamps(keycode, record);
+    pre_process_typing_speed(keycode, record);
+#ifdef KEY_TRACE_ENABLE
+    pre_process_key_trace(keycode, record);
+#endif
+#ifdef COMBO_STATS_ENABLE
+    pre_process_combo_stats(keycode, record);
+#endif
+#ifdef SCAN_BENCH_ENABLE
+    pre_process_scan_bench(keycode, record);
+#endif
+    return true;
+}
+
 bool process_record_user(uint16_t keycode, keyrecord_t* record)
 {
+#ifdef COMBO_STATS_ENABLE
+    process_combo_stats(keycode, record);
+#endif
     if(!process_achordion(keycode, record))
     {
         return false;
     }
+    if(!process_thumb_layer(keycode, record))
+    {
+        return false;
+    }
+    if(!process_leader_trie(keycode, record))
+    {
+        return false;
+    }
+    process_macro_recorder(keycode, record);
+    if(!process_mouse_motion(keycode, record))
+    {
+        return false;
+    }
+    if(!process_compose(keycode, record))
+    {
+        return false;
+    }
+    if(!process_mod_session(keycode, record))
+    {
+        return false;
+    }
+    process_key_history(keycode, record);
+    if(!process_vim_pending(keycode, record))
+    {
+        return false;
+    }
+    if(!process_text_expansion(keycode, record))
+    {
+        return false;
+    }
 
-    const uint8_t hold_mods    = get_mods();
-    const uint8_t oneshot_mods = get_oneshot_mods();
-    const uint8_t mods         = hold_mods | oneshot_mods;
-    switch(keycode)
+    const uint16_t shortcut = shortcut_for(keycode);
+    if(shortcut != KC_NO)
     {
-    // These become dead keys with US International layout but i only want that on the accent layer, so just send a space after the dead key
-    // if it is not the accent layer
-    case KC_QUOT:
-    case KC_GRV:
-    case KC_DQUO:
-    case KC_TILD:
-    case KC_CIRC:
         if(record->event.pressed)
         {
-            if(!layer_state_is(ACCENT_LAYER))
-            {
-                tap_code16(keycode);
-                tap_code16(KC_SPC);
-            }
-            else
+            tap_code16(shortcut);
+            if(keycode == FIND || keycode == RUN)
             {
-                tap_code16(keycode);
+                layer_move(ALPHA_LAYER);
             }
         }
         return false;
+    }
+
+    const uint8_t hold_mods    = get_mods();
+    const uint8_t oneshot_mods = get_oneshot_mods();
+    const uint8_t mods         = hold_mods | oneshot_mods;
+    switch(keycode)
+    {
     case KC_COMM:
         if(record->event.pressed)
         {
             if((mods & MOD_MASK_SHIFT) && layer_state_is(ALPHA_LAYER))
             {
+                // Lift Shift without a report of its own, the quote press carries it.
                 del_oneshot_mods(MOD_MASK_SHIFT);
-                unregister_mods(MOD_MASK_SHIFT);
-                tap_code16(KC_QUOT);
-                tap_code16(KC_SPC);
-                register_mods(hold_mods);  // Restore mods.
+                del_mods(MOD_MASK_SHIFT);
+                compose_tap_dead_key(KC_QUOT);
+                set_mods(hold_mods);  // Restore mods.
+                send_keyboard_report();
             }
             else
             {
@@ -264,34 +413,6 @@ bool process_record_user(uint16_t keycode, keyrecord_t* record)
     //         }
     //     }
     //     return false;
-    case SYM_WIN_LAYER:
-        if(record->tap.count > 0)  // tap
-        {
-            if(record->event.pressed)
-            {
-                // tap press
-                layer_move(SYM_LAYER);
-            }
-            else
-            {
-                // tap release
-            }
-        }
-        else  // hold
-        {
-            // emulate a momentary layer hold key, like MO
-            if(record->event.pressed)
-            {
-                // hold press
-                layer_move(WIN_NAV_LAYER);
-            }
-            else
-            {
-                // hold release
-                layer_move(ALPHA_LAYER);
-            }
-        }
-        return false;
     case ESC_ALPHA_LAYER:
         if(record->event.pressed)
         {
@@ -304,224 +425,103 @@ bool process_record_user(uint16_t keycode, keyrecord_t* record)
         {
             if(mods & MOD_MASK_SHIFT)
             {  // Is shift held?
-                // Temporarily delete shift.
-                del_oneshot_mods(MOD_MASK_SHIFT);
-                unregister_mods(MOD_MASK_SHIFT);
-                SEND_STRING("->");
-                register_mods(hold_mods);  // Restore mods.
+                send_arrow();
             }
             else
             {
-                SEND_STRING(".");
+                tap_code(KC_DOT);
+                key_history_push(KC_DOT, 0);
             }
         }
         return false;
     case VIM_F:
         if(record->event.pressed)
         {
-            SEND_STRING("f");
+            tap_code(KC_F);
+            key_history_push(KC_F, 0);
             layer_move(ALPHA_LAYER);
         }
         return false;
     case VIM_FF:
         if(record->event.pressed)
         {
-            SEND_STRING(SS_LSFT("f"));
+            tap_code16(LSFT(KC_F));
+            key_history_push(LSFT(KC_F), 0);
             layer_move(ALPHA_LAYER);
         }
         return false;
     case VIM_T:
         if(record->event.pressed)
         {
-            SEND_STRING("t");
+            tap_code(KC_T);
+            key_history_push(KC_T, 0);
             layer_move(ALPHA_LAYER);
         }
         return false;
     case VIM_TT:
         if(record->event.pressed)
         {
-            SEND_STRING(SS_LSFT("t"));
-            layer_move(ALPHA_LAYER);
-        }
-        return false;
-    case COPY:
-        if(record->event.pressed)
-        {
-            SEND_STRING(SS_LCTL("c"));
-        }
-        return false;
-    case CUT:
-        if(record->event.pressed)
-        {
-            SEND_STRING(SS_LCTL("x"));
-        }
-        return false;
-    case PASTE:
-        if(record->event.pressed)
-        {
-            SEND_STRING(SS_LCTL("v"));
-        }
-        return false;
-    case UNDO:
-        if(record->event.pressed)
-        {
-            SEND_STRING(SS_LCTL("z"));
-        }
-        return false;
-    case REDO:
-        if(record->event.pressed)
-        {
-            SEND_STRING(SS_LCTL("y"));
-        }
-        return false;
-    case FIND:
-        if(record->event.pressed)
-        {
-            SEND_STRING(SS_LCTL("f"));
-            layer_move(ALPHA_LAYER);
-        }
-        return false;
-    case RUN:
-        if(record->event.pressed)
-        {
-            SEND_STRING(SS_LCTL(SS_LSFT(SS_LGUI(SS_LALT(" ")))));
+            tap_code16(LSFT(KC_T));
+            key_history_push(LSFT(KC_T), 0);
             layer_move(ALPHA_LAYER);
         }
         return false;
-    case ALTTAB:
-        if(record->event.pressed)
-        {
-            if(!is_alt_tab_active)
-            {
-                is_alt_tab_active = true;
-                register_code(KC_LALT);
-            }
-            alt_tab_timer = timer_read();
-            register_code(KC_TAB);
-        }
-        else
-        {
-            unregister_code(KC_TAB);
-        }
-        return true;
 
-    case WIN_1:
-        if(record->event.pressed)
-        {
-            SEND_STRING(SS_LGUI("1"));
-        }
-        return false;
-    case WIN_2:
+    case REPEAT:
         if(record->event.pressed)
         {
-            SEND_STRING(SS_LGUI("2"));
+            key_history_repeat();
         }
         return false;
-    case WIN_3:
-        if(record->event.pressed)
-        {
-            SEND_STRING(SS_LGUI("3"));
-        }
-        return false;
-    case WIN_4:
-        if(record->event.pressed)
-        {
-            SEND_STRING(SS_LGUI("4"));
-        }
-        return false;
-    case WIN_5:
+    case MAGIC:
         if(record->event.pressed)
         {
-            SEND_STRING(SS_LGUI("5"));
+            key_history_magic();
         }
         return false;
-    case WIN_6:
+#ifdef COMBO_STATS_ENABLE
+    case COMBO_STATS:
         if(record->event.pressed)
         {
-            SEND_STRING(SS_LGUI("6"));
+            combo_stats_dump();
         }
         return false;
-    case WIN_7:
-        if(record->event.pressed)
-        {
-            SEND_STRING(SS_LGUI("7"));
-        }
-        return false;
-    case WIN_8:
-        if(record->event.pressed)
-        {
-            SEND_STRING(SS_LGUI("8"));
-        }
-        return false;
-    case WIN_FULL:
-        if(record->event.pressed)
-        {
-            SEND_STRING(SS_LGUI(SS_TAP(X_UP)));
-        }
-        return false;
-    case WIN_MIN:
-        if(record->event.pressed)
-        {
-            SEND_STRING(SS_LGUI(SS_TAP(X_DOWN)));
-        }
-        return false;
-    case WIN_LEFT:
+#endif
+    case MREC:
         if(record->event.pressed)
         {
-            SEND_STRING(SS_LGUI(SS_TAP(X_LEFT)));
+            macro_recorder_toggle();
         }
         return false;
-    case WIN_RIGHT:
+    case MPLAY:
         if(record->event.pressed)
         {
-            SEND_STRING(SS_LGUI(SS_TAP(X_RIGHT)));
+            macro_recorder_play();
         }
         return false;
-    case WIN_SCL:
+    case TYPING_SPEED:
         if(record->event.pressed)
         {
-            SEND_STRING(SS_LGUI(SS_LSFT(SS_TAP(X_LEFT))));
+            typing_speed_dump();
         }
         return false;
-    case WIN_SCR:
+    case LEADER:
         if(record->event.pressed)
         {
-            SEND_STRING(SS_LGUI(SS_LSFT(SS_TAP(X_RIGHT))));
+            // Sequences are typed on the alpha layer.
+            layer_move(ALPHA_LAYER);
+            leader_trie_start();
         }
         return false;
 
     case ACC_E:
-        if(record->event.pressed)
-        {
-            tap_code(KC_E);
-            layer_move(ALPHA_LAYER);
-        }
-        return false;
     case ACC_A:
-        if(record->event.pressed)
-        {
-            tap_code(KC_A);
-            layer_move(ALPHA_LAYER);
-        }
-        return false;
+    case ACC_I:
     case ACC_O:
-        if(record->event.pressed)
-        {
-            tap_code(KC_O);
-            layer_move(ALPHA_LAYER);
-        }
-        return false;
     case ACC_U:
+        // The accented letter was already sent by process_compose.
         if(record->event.pressed)
         {
-            tap_code(KC_U);
-            layer_move(ALPHA_LAYER);
-        }
-        return false;
-    case ACC_I:
-        if(record->event.pressed)
-        {
-            tap_code(KC_I);
             layer_move(ALPHA_LAYER);
         }
         return false;
@@ -533,15 +533,22 @@ bool process_record_user(uint16_t keycode, keyrecord_t* record)
 
 void matrix_scan_user(void)
 {
-    if(is_alt_tab_active)
+#ifdef SCAN_BENCH_ENABLE
+    scan_bench_scan_start();
+#endif
+    report_coalesce_begin();
+    // The press that wakes the slow stage has no other key to be ordered
+    // against, it keeps the master's time.
+    if(idle_scheduler_stage() != IDLE_SLOW)
     {
-        if(timer_elapsed(alt_tab_timer) > 1000)
-        {
-            unregister_code(KC_LALT);
-            is_alt_tab_active = false;
-        }
+        split_timestamps_master_scan();
     }
     achordion_task();
+    thumb_layer_task();
+}
+void matrix_slave_scan_user(void)
+{
+    split_timestamps_slave_scan();
 }
 // clang-format off
 const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
@@ -554,7 +561,7 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
 
 
 	[SYM_LAYER] = LAYOUT_split_3x5_2(
-            KC_CIRC, KC_TILD, KC_HASH, KC_COLN, KC_GRV,      KC_SCLN, KC_PERC, KC_SLSH, KC_BSLS, KC_NO,
+            KC_CIRC, KC_TILD, KC_HASH, KC_COLN, KC_GRV,      KC_SCLN, KC_PERC, KC_SLSH, KC_BSLS, LEADER,
             KC_AMPR, KC_ASTR, KC_LBRC, KC_LPRN, KC_LCBR,     KC_RCBR, KC_RPRN, KC_RBRC, KC_DQUO, KC_PLUS,
             KC_DLR,  KC_LT,   KC_GT,   KC_EXLM, KC_PIPE,     KC_AT,   KC_QUES, KC_EQL,  KC_QUOT, TO(FN_LAYER),
 
@@ -568,21 +575,21 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
                                TO(ALPHA_LAYER), KC_BSPC,    NAV_HOLD, TO(SYM_LAYER)),
 
     [NAV_LAYER] = LAYOUT_split_3x5_2(
-            KC_NO,      KC_Y,        KC_P,  KC_LSFT,  KC_LCBR,      LCTL(KC_U),    KC_P2,   KC_P3,   KC_P4, KC_NO,
+            KC_D,       KC_Y,        KC_P,  KC_LSFT,  KC_LCBR,      LCTL(KC_U),    KC_P2,   KC_P3,   KC_P4, KC_NO,
             KC_W,       KC_B,        KC_E,  KC_LCTL,  KC_RCBR,      LCTL(KC_D),    KC_LEFT, KC_DOWN, KC_UP, KC_RGHT,
             LSFT(KC_V), LCTL(KC_V),  KC_V,  KC_CIRC,  KC_DLR,       KC_NO,         KC_COMM, KC_SCLN, KC_NO, KC_ESC,
 
                                     TO(ALPHA_LAYER),  KC_LALT,      KC_NO, KC_NO),
 
     [WIN_NAV_LAYER] = LAYOUT_split_3x5_2(
-            KC_NO, WIN_MIN,  WIN_FULL,  KC_NO,  KC_NO,      KC_NO,   KC_NO, KC_NO, KC_NO, KC_NO,
-            WIN_1, WIN_2,    WIN_3,     WIN_4,  WIN_SCL,    WIN_SCR, WIN_5, WIN_6, WIN_7, WIN_8,
-            KC_NO, WIN_LEFT, WIN_RIGHT, ALTTAB, KC_NO,      KC_NO,   KC_NO, KC_NO, KC_NO, KC_NO,
+            KC_NO,  WIN_MIN,  WIN_FULL,  CTLPGDN, KC_NO,      KC_NO,   KC_NO, KC_NO, KC_NO, KC_NO,
+            WIN_1,  WIN_2,    WIN_3,     WIN_4,   WIN_SCL,    WIN_SCR, WIN_5, WIN_6, WIN_7, WIN_8,
+            GUITAB, WIN_LEFT, WIN_RIGHT, ALTTAB,  CTLTAB,     KC_NO,   KC_NO, KC_NO, KC_NO, KC_NO,
 
                             LCTL(KC_LSFT), RUN,      KC_NO, KC_NO),
 
     [FN_LAYER] = LAYOUT_split_3x5_2(
-            TO(QMK_LAYER),   KC_NO,  KC_NO,   KC_NO,   KC_NO,      KC_NO, KC_F7, KC_F8, KC_F9, KC_F12,
+            TO(QMK_LAYER),   MREC,   MPLAY,   KC_NO,   KC_NO,      KC_NO, KC_F7, KC_F8, KC_F9, KC_F12,
             UNDO,            CUT,    COPY,    PASTE,   FIND,       KC_NO, KC_F4, KC_F5, KC_F6, KC_F11,
             KC_NO,           KC_NO,  KC_NO,   KC_NO,   KC_NO,      KC_NO, KC_F1, KC_F2, KC_F3, KC_F10,
 
@@ -590,7 +597,7 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
 
     [MEDIA_LAYER] = LAYOUT_split_3x5_2(
             KC_NO,   KC_NO,   KC_VOLU, KC_NO,   KC_NO,      KC_NO, KC_NO,   KC_MS_BTN3, KC_NO,   KC_NO,
-            KC_MUTE, KC_MPRV, KC_MPLY, KC_MNXT, KC_NO,      KC_NO, KC_MS_L, KC_MS_D,    KC_MS_U, KC_MS_R,
+            KC_MUTE, KC_MPRV, KC_MPLY, KC_MNXT, KC_ACL0,    KC_NO, KC_MS_L, KC_MS_D,    KC_MS_U, KC_MS_R,
             KC_NO,   KC_NO,   KC_VOLD, KC_NO,   KC_NO,      KC_NO, KC_WH_L, KC_WH_D,    KC_WH_U, KC_WH_R,
 
                           TO(ALPHA_LAYER), KC_MS_BTN1,      KC_MS_BTN2, KC_NO),
@@ -609,9 +616,9 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
                              TO(ALPHA_LAYER), KC_BSPC,      KC_SPC, OSM(MOD_LSFT)),
 
     [QMK_LAYER] = LAYOUT_split_3x5_2(
-            QK_BOOT, KC_NO, KC_NO, KC_NO, KC_NO,      KC_NO, KC_NO, KC_NO, KC_NO, QK_RBT,
-            KC_NO,   KC_NO, KC_NO, KC_NO, UG_TOGG,      KC_NO, KC_NO, KC_NO, KC_NO, KC_NO,
-            EE_CLR,  KC_NO, KC_NO, KC_NO, KC_NO,      KC_NO, KC_NO, KC_NO, KC_NO, KC_NO,
+            QK_BOOT, KC_NO,       KC_NO,        KC_NO, KC_NO,        KC_NO, KC_NO, KC_NO, KC_NO, QK_RBT,
+            KC_NO,   KC_NO,       KC_NO,        KC_NO, UG_TOGG,      KC_NO, KC_NO, KC_NO, KC_NO, KC_NO,
+            EE_CLR,  COMBO_STATS, TYPING_SPEED, KC_NO, KC_NO,        KC_NO, KC_NO, KC_NO, KC_NO, KC_NO,
 
                          TO(ALPHA_LAYER), KC_NO,      KC_NO, KC_NO)
 
@@ -621,92 +628,72 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
 // turn off power led
 void keyboard_pre_init_user(void)
 {
-    // Set our LED pin as output
-    setPinOutput(24);
-    // Turn the LED off
-    // (Due to technical reasons, high is off and low is on)
-    writePinHigh(24);
+    indicator_init();
 }
 void keyboard_post_init_user(void)
 {
+    split_timestamps_init();
+    macro_recorder_init();
     // Initialize RGB to static black
     rgblight_enable_noeeprom();
     rgblight_sethsv_noeeprom(HSV_BLACK);
     rgblight_mode_noeeprom(RGBLIGHT_MODE_STATIC_LIGHT);
+#ifdef SCAN_BENCH_ENABLE
+    scan_bench_init();
+#endif
 }
 void oneshot_mods_changed_user(uint8_t mods)
 {
-    if(mods & MOD_MASK_SHIFT)
-    {
-        setPinOutput(24);
-        // Turn the LED on
-        // (Due to technical reasons, high is off and low is on)
-        writePinLow(24);
-    }
-    else
-    {
-        if(!is_caps_word_on())
-        {
-            setPinOutput(24);
-            // Turn the LED off
-            // (Due to technical reasons, high is off and low is on)
-            writePinHigh(24);
-        }
-    }
+    indicator_set(INDICATOR_ONESHOT_SHIFT, mods & MOD_MASK_SHIFT);
 }
 void caps_word_set_user(bool active)
 {
-    if(active)
-    {
-        // Do something when Caps Word activates.
-        setPinOutput(24);
-        // Turn the LED on
-        // (Due to technical reasons, high is off and low is on)
-        writePinLow(24);
-    }
-    else
-    {
-        // Do something when Caps Word deactivates.
-        setPinOutput(24);
-        // Turn the LED off
-        // (Due to technical reasons, high is off and low is on)
-        writePinHigh(24);
-    }
+    indicator_set(INDICATOR_CAPS_WORD, active);
+}
+
+// clang-format off
+static const uint8_t PROGMEM layer_colors[][3] = {
+    [ALPHA_LAYER]   = {RGB_BLACK},
+    [SYM_LAYER]     = {RGB_RED},
+    [NUM_LAYER]     = {RGB_GREEN},
+    [NAV_LAYER]     = {RGB_BLUE},
+    [WIN_NAV_LAYER] = {RGB_PURPLE},
+    [FN_LAYER]      = {RGB_YELLOW},
+    [MEDIA_LAYER]   = {RGB_PINK},
+    [GAMING_LAYER]  = {RGB_TEAL},
+    [ACCENT_LAYER]  = {RGB_ORANGE},
+    [QMK_LAYER]     = {RGB_WHITE},
+};
+// clang-format on
+
+void indicator_rgb_user(uint16_t status, uint8_t rgb[3])
+{
+    // Keep the window switcher color while Alt is still held by ALTTAB.
+    const uint8_t layer = (status & INDICATOR_ALT_TAB) ? WIN_NAV_LAYER : INDICATOR_LAYER(status);
+    memcpy_P(rgb, layer_colors[layer], 3);
+}
+
+layer_state_t layer_state_set_user(layer_state_t state)
+{
+    state = exclusive_layer_state_set(state);
+    // Whatever is buffered belongs to the layer being left.
+    vim_pending_flush();
+    indicator_set_layer(exclusive_layer_get());
+    return state;
+}
+bool idle_busy_user(void)
+{
+    return mouse_motion_active();
 }
 void housekeeping_task_user(void)
 {
-    switch(get_highest_layer(layer_state | default_layer_state))
+    report_coalesce_end();
+#ifdef SCAN_BENCH_ENABLE
+    scan_bench_task();
+#endif
+    if(idle_scheduler_task() == IDLE_ACTIVE)
     {
-    case ALPHA_LAYER:
-        // Default layer
-        rgblight_setrgb_at(RGB_BLACK, 0);
-        break;
-    case SYM_LAYER:
-        rgblight_setrgb_at(RGB_RED, 0);
-        break;
-    case NUM_LAYER:
-        rgblight_setrgb_at(RGB_GREEN, 0);
-        break;
-    case NAV_LAYER:
-        rgblight_setrgb_at(RGB_BLUE, 0);
-        break;
-    case WIN_NAV_LAYER:
-        rgblight_setrgb_at(RGB_PURPLE, 0);
-        break;
-    case FN_LAYER:
-        rgblight_setrgb_at(RGB_YELLOW, 0);
-        break;
-    case MEDIA_LAYER:
-        rgblight_setrgb_at(RGB_PINK, 0);
-        break;
-    case GAMING_LAYER:
-        rgblight_setrgb_at(RGB_TEAL, 0);
-        break;
-    case ACCENT_LAYER:
-        rgblight_setrgb_at(RGB_ORANGE, 0);
-        break;
-    case QMK_LAYER:
-        rgblight_setrgb_at(RGB_WHITE, 0);
-        break;
+        indicator_task();
     }
+    mouse_motion_task();
 }
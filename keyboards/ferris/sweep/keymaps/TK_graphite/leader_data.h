@@ -0,0 +1,43 @@
+// Generated by make_leader_data.py from leader.def, do not edit.
+#pragma once
+
+#define LEADER_TRIE_SIZE 67
+
+const uint16_t PROGMEM leader_trie[LEADER_TRIE_SIZE] = {
+    11, KC_C, 0x8000, KC_X, 0x8001, KC_V, 0x8002, KC_U,
+    0x8003, KC_Y, 0x8004, KC_F, 0x8005, KC_R, 0x8006, KC_W,
+    23, KC_G, 55, KC_M, 58, KC_Q, 61, 13,
+    KC_N, 0x8007, KC_R, 0x8008, KC_T, 0x8009, KC_S, 0x800A,
+    KC_H, 0x800B, KC_A, 0x800C, KC_E, 0x800D, KC_I, 0x800E,
+    KC_F, 0x800F, KC_M, 0x8010, KC_L, 0x8011, KC_D, 0x8012,
+    KC_C, 50, 2, KC_L, 0x8013, KC_D, 0x8014, 1,
+    KC_A, 0x8015, 1, KC_E, 0x8016, 1, KC_M, 64,
+    1, KC_K, 0x8017,
+};
+
+const uint16_t PROGMEM leader_actions[] = {
+    COPY,  // copy: KC_C
+    CUT,  // cut: KC_X
+    PASTE,  // paste: KC_V
+    UNDO,  // undo: KC_U
+    REDO,  // redo: KC_Y
+    FIND,  // find: KC_F
+    RUN,  // run: KC_R
+    WIN_1,  // win_1: KC_W KC_N
+    WIN_2,  // win_2: KC_W KC_R
+    WIN_3,  // win_3: KC_W KC_T
+    WIN_4,  // win_4: KC_W KC_S
+    WIN_5,  // win_5: KC_W KC_H
+    WIN_6,  // win_6: KC_W KC_A
+    WIN_7,  // win_7: KC_W KC_E
+    WIN_8,  // win_8: KC_W KC_I
+    WIN_FULL,  // win_full: KC_W KC_F
+    WIN_MIN,  // win_min: KC_W KC_M
+    WIN_LEFT,  // win_left: KC_W KC_L
+    WIN_RIGHT,  // win_right: KC_W KC_D
+    WIN_SCL,  // win_screen_left: KC_W KC_C KC_L
+    WIN_SCR,  // win_screen_right: KC_W KC_C KC_D
+    TO(GAMING_LAYER),  // gaming: KC_G KC_A
+    TO(MEDIA_LAYER),  // media: KC_M KC_E
+    TO(QMK_LAYER),  // qmk: KC_Q KC_M KC_K
+};
@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+"""Compiles leader.def into the flash trie in leader_data.h.
+
+The trie is an array of 16-bit words. An inner node is its child count
+followed by (keycode, child offset) pairs. A leaf is 0x8000 | action index
+into leader_actions. Keycodes are copied as C expressions, so the header has
+to be included from keymap.c where the custom keycodes are defined.
+
+Usage:
+  make_leader_data.py [def] [-o header] [--check]
+
+With --check nothing is written, the exit status tells whether the header is
+up to date. rules.mk runs it so a stale leader_data.h fails the build.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+LEAF = 0x8000
+
+
+def split_args(text):
+    args, depth, current = [], 0, ""
+    for char in text:
+        if char == "," and depth == 0:
+            args.append(current.strip())
+            current = ""
+            continue
+        depth += {"(": 1, ")": -1}.get(char, 0)
+        current += char
+    args.append(current.strip())
+    return args
+
+
+def parse(path):
+    sequences = []
+    with open(path) as f:
+        for line_number, line in enumerate(f, 1):
+            line = line.split("//", 1)[0].strip()
+            if not line:
+                continue
+            match = re.fullmatch(r"LEAD\((.*)\)", line)
+            if not match:
+                sys.exit(f"{path}:{line_number}: expected LEAD(name, action, keys...)")
+            args = split_args(match.group(1))
+            if len(args) < 3:
+                sys.exit(f"{path}:{line_number}: '{args[0]}' needs an action and at least one key")
+            sequences.append((line_number, args[0], args[1], tuple(args[2:])))
+    return sequences
+
+
+def check(sequences):
+    for i, (line_a, name_a, _, keys_a) in enumerate(sequences):
+        for line_b, name_b, _, keys_b in sequences[i + 1:]:
+            shorter, longer = sorted((keys_a, keys_b), key=len)
+            if longer[:len(shorter)] == shorter:
+                sys.exit(f"lines {line_a} and {line_b}: '{name_a}' and '{name_b}' overlap, "
+                         "one sequence may not be the prefix of another")
+
+
+def serialize(sequences):
+    trie = {}
+    for index, (_, _, _, keys) in enumerate(sequences):
+        node = trie
+        for key in keys[:-1]:
+            node = node.setdefault(key, {})
+        node[keys[-1]] = index
+
+    words = []
+
+    def emit(node):
+        start = len(words)
+        # Offsets and action indices share a word with the leaf bit.
+        if start >= LEAF:
+            sys.exit(f"the trie exceeds {LEAF} words, offsets no longer fit in 15 bits")
+        words.append(str(len(node)))
+        words.extend(["0", "0"] * len(node))
+        for i, (key, child) in enumerate(node.items()):
+            if isinstance(child, int):
+                target = f"0x{LEAF | child:04X}"
+            else:
+                target = str(emit(child))
+            words[start + 1 + 2 * i:start + 3 + 2 * i] = [key, target]
+        return start
+
+    if len(sequences) > LEAF:
+        sys.exit(f"{len(sequences)} sequences, action indices only fit in 15 bits")
+    emit(trie)
+    return words
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("definitions", nargs="?", default="leader.def")
+    parser.add_argument("-o", "--output", default="leader_data.h")
+    parser.add_argument("--check", action="store_true", help="only check that the header is up to date")
+    args = parser.parse_args()
+
+    sequences = parse(args.definitions)
+    check(sequences)
+    words = serialize(sequences)
+
+    # The header names the definitions by file name only, so --check doesn't
+    # depend on the directory it runs from.
+    lines = ["// Generated by make_leader_data.py from " + os.path.basename(args.definitions) + ", do not edit.",
+             "#pragma once",
+             "",
+             f"#define LEADER_TRIE_SIZE {len(words)}",
+             "",
+             "const uint16_t PROGMEM leader_trie[LEADER_TRIE_SIZE] = {"]
+    for i in range(0, len(words), 8):
+        lines.append("    " + " ".join(w + "," for w in words[i:i + 8]))
+    lines += ["};", "", "const uint16_t PROGMEM leader_actions[] = {"]
+    for _, name, action, keys in sequences:
+        lines.append(f"    {action},  // {name}: {' '.join(keys)}")
+    lines.append("};")
+    header = "\n".join(lines) + "\n"
+
+    if args.check:
+        try:
+            with open(args.output) as f:
+                current = f.read()
+        except FileNotFoundError:
+            current = None
+        if current != header:
+            sys.exit(f"{args.output} is out of date, run make_leader_data.py")
+        return
+
+    with open(args.output, "w") as f:
+        f.write(header)
+    print(f"{len(sequences)} sequences, {2 * len(words)} bytes of trie")
+
+
+if __name__ == "__main__":
+    main()
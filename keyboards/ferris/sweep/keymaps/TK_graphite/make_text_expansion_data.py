@@ -0,0 +1,217 @@
+#!/usr/bin/env python3
+"""Compiles text_expansion_dict.txt into the flash trie in text_expansion_data.h.
+
+Typos are reversed and stored in a pointer-free trie so the firmware can match
+the rolling buffer backwards from the last typed key in O(word length).
+
+Node encoding, one byte per key code (all key codes are below 64):
+  * Branch: entries of [64 | key, offset in 3 bytes, low first], terminated
+            by 0.
+  * Chain:  key codes matched one after another, terminated by 0, followed
+            directly by the child node.
+  * Leaf:   [128 | 64 if the boundary key is resent | backspaces], followed by
+            the null-terminated replacement text.
+
+Usage:
+  make_text_expansion_data.py [--budget BYTES] [dict] [-o header]
+
+With --budget, the longest prefix of the dictionary (in file order) that fits
+is kept and the dropped entries are reported.
+"""
+
+import argparse
+import sys
+
+KC_A = 0x04
+KC_SPC = 0x2C
+BOUNDARY = ":"
+
+
+# Branch offsets are 24 bits, 16 MiB, more than any flash the trie goes in.
+OFFSET_BYTES = 3
+MAX_SIZE = (1 << 8 * OFFSET_BYTES) - 1
+ENTRY_SIZE = 1 + OFFSET_BYTES
+
+
+class TooLarge(Exception):
+    pass
+
+
+def key_code(char):
+    if char == BOUNDARY:
+        return KC_SPC
+    return KC_A + ord(char) - ord("a")
+
+
+def parse(path):
+    entries = []
+    with open(path) as f:
+        for line_number, line in enumerate(f, 1):
+            line = line.strip()
+            if not line or line.startswith("#"):
+                continue
+            if "->" not in line:
+                sys.exit(f"{path}:{line_number}: expected 'typo -> replacement'")
+            typo, replacement = (part.strip() for part in line.split("->", 1))
+            typo = typo.lower()
+            if not typo.strip(BOUNDARY) or any(c != BOUNDARY and not "a" <= c <= "z" for c in typo):
+                sys.exit(f"{path}:{line_number}: typo '{typo}' may only contain a-z and '{BOUNDARY}'")
+            if BOUNDARY in typo.strip(BOUNDARY):
+                sys.exit(f"{path}:{line_number}: '{BOUNDARY}' is only allowed at the ends of '{typo}'")
+            if not replacement or any(not " " <= c <= "~" or c in "'\"`^~" for c in replacement):
+                sys.exit(f"{path}:{line_number}: replacement '{replacement}' must be plain ASCII without dead keys")
+            entries.append((line_number, typo, replacement))
+    return entries
+
+
+def check_suffixes(entries):
+    # Matching stops at the first leaf, so a typo that ends with another typo
+    # would never fire.
+    lines = {}
+    for line_b, b, _ in sorted(entries, key=lambda e: len(e[1])):
+        for start in range(len(b)):
+            a = b[start:]
+            if a in lines:
+                sys.exit(f"line {line_b}: '{b}' can never trigger, it ends with '{a}' (line {lines[a]})")
+        lines[b] = line_b
+
+
+def leaf(typo, replacement):
+    resend = typo.endswith(BOUNDARY)
+    typed = typo.strip(BOUNDARY)
+    # Keys already sent before the key that completes the match.
+    before = typed if resend else typed[:-1]
+    common = 0
+    while common < min(len(before), len(replacement)) and before[common] == replacement[common]:
+        common += 1
+    backspaces = len(before) - common
+    if backspaces > 63:
+        sys.exit(f"'{typo}' needs more than 63 backspaces")
+    return [128 | (64 if resend else 0) | backspaces] + [ord(c) for c in replacement[common:]] + [0]
+
+
+def serialize(entries):
+    trie = {}
+    for _, typo, replacement in entries:
+        node = trie
+        for char in reversed(typo):
+            node = node.setdefault(key_code(char), {})
+        node[None] = leaf(typo, replacement)
+
+    data = []
+
+    def emit(node):
+        if None in node:
+            data.extend(node[None])
+            return
+        if len(node) == 1:
+            while len(node) == 1 and None not in node:
+                code, node = next(iter(node.items()))
+                data.append(code)
+            data.append(0)
+            emit(node)
+            return
+        start = len(data)
+        data.extend([0] * (ENTRY_SIZE * len(node) + 1))
+        for i, (code, child) in enumerate(sorted(node.items())):
+            offset = len(data)
+            if offset > MAX_SIZE:
+                raise TooLarge()
+            entry = start + ENTRY_SIZE * i
+            data[entry] = 64 | code
+            data[entry + 1:entry + ENTRY_SIZE] = offset.to_bytes(OFFSET_BYTES, "little")
+            emit(child)
+
+    emit(trie)
+    return data
+
+
+def size(entries):
+    try:
+        return len(serialize(entries))
+    except TooLarge:
+        return float("inf")
+
+
+def worst_case_reads(entries, data):
+    # Bytes read by the firmware to match the most expensive dictionary word,
+    # a bound on the per-keystroke matching cost.
+    worst = 0
+    for _, typo, _ in entries:
+        reads = 0
+        state = 0
+        for char in reversed(typo):
+            code = key_code(char)
+            if data[state] & 64:
+                while data[state] != code | 64:
+                    state += ENTRY_SIZE
+                    reads += 1
+                reads += ENTRY_SIZE
+                state = int.from_bytes(data[state + 1:state + ENTRY_SIZE], "little")
+            else:
+                reads += 1
+                state += 1
+                if data[state] == 0:
+                    state += 1
+                    reads += 1
+        worst = max(worst, reads)
+    return worst
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("dict", nargs="?", default="text_expansion_dict.txt")
+    parser.add_argument("-o", "--output", default="text_expansion_data.h")
+    parser.add_argument("--budget", type=int, help="maximum size of the trie in bytes")
+    args = parser.parse_args()
+
+    entries = parse(args.dict)
+    check_suffixes(entries)
+
+    if args.budget is not None and args.budget > MAX_SIZE:
+        sys.exit(f"--budget {args.budget} exceeds the {MAX_SIZE} bytes reachable with 24-bit offsets")
+    if args.budget is None and size(entries) > MAX_SIZE:
+        sys.exit(f"the trie of {len(entries)} entries exceeds the {MAX_SIZE} bytes reachable with 24-bit "
+                 f"offsets, pass --budget to keep the first entries that fit")
+
+    kept = len(entries)
+    budget = args.budget if args.budget is not None else MAX_SIZE
+    if size(entries) > budget:
+        # Largest prefix of the priority-ordered dictionary that fits.
+        low, high = 0, len(entries)
+        while low < high:
+            mid = (low + high + 1) // 2
+            if size(entries[:mid]) <= budget:
+                low = mid
+            else:
+                high = mid - 1
+        kept = low
+    chosen, dropped = entries[:kept], entries[kept:]
+    if not chosen:
+        sys.exit("no entry fits the budget")
+    data = serialize(chosen)
+
+    for line_number, typo, replacement in dropped:
+        print(f"dropped  line {line_number:4}: {typo} -> {replacement}")
+    of_budget = f" of {args.budget}" if args.budget is not None else ""
+    print(f"{len(chosen)} of {len(entries)} entries, {len(data)}{of_budget} bytes, "
+          f"at most {worst_case_reads(chosen, data)} bytes read per keystroke")
+
+    typos = [typo for _, typo, _ in chosen]
+    with open(args.output, "w") as f:
+        f.write("// Generated by make_text_expansion_data.py from " + args.dict + ", do not edit.\n")
+        f.write("#pragma once\n\n")
+        for _, typo, replacement in chosen:
+            f.write(f"// {typo:<16} -> {replacement}\n")
+        f.write("\n")
+        f.write(f"#define TEXT_EXPANSION_MIN_LENGTH {min(len(t) for t in typos)}\n")
+        f.write(f"#define TEXT_EXPANSION_MAX_LENGTH {max(len(t) for t in typos)}\n")
+        f.write(f"#define TEXT_EXPANSION_DATA_SIZE {len(data)}\n\n")
+        f.write("static const uint8_t text_expansion_data[TEXT_EXPANSION_DATA_SIZE] PROGMEM = {\n")
+        for i in range(0, len(data), 16):
+            f.write("    " + " ".join(f"0x{b:02X}," for b in data[i:i + 16]) + "\n")
+        f.write("};\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -3,8 +3,58 @@ CAPS_WORD_ENABLE = yes
 SPLIT_KEYBOARD = yes
 COMBO_ENABLE = yes
 MOUSEKEY_ENABLE = yes
+DEFERRED_EXEC_ENABLE = yes
 
+SRC += tap_hold.c
 SRC += features/achordion.c
+SRC += features/compose.c
+SRC += features/exclusive_layer.c
+SRC += features/idle_scheduler.c
+SRC += features/indicator.c
+SRC += features/key_history.c
+SRC += features/keycode_event.c
+SRC += features/leader_trie.c
+SRC += features/macro_recorder.c
+SRC += features/mod_session.c
+SRC += features/mouse_curve.c
+SRC += features/mouse_motion.c
+SRC += features/report_coalesce.c
+SRC += features/split_timestamps.c
+SRC += features/text_expansion.c
+SRC += features/thumb_layer.c
+SRC += features/typing_speed.c
+SRC += features/vim_pending.c
+
+# leader_data.h is generated from leader.def, a stale copy fails the build.
+LEADER_DATA_CHECK := $(shell python3 $(KEYMAP_PATH)/make_leader_data.py --check $(KEYMAP_PATH)/leader.def -o $(KEYMAP_PATH)/leader_data.h 2>&1)
+ifneq ($(strip $(LEADER_DATA_CHECK)),)
+    $(error $(LEADER_DATA_CHECK))
+endif
+
+# Console trace of key events for debugging, see features/key_trace.h.
+KEY_TRACE_ENABLE ?= no
+ifeq ($(strip $(KEY_TRACE_ENABLE)), yes)
+    CONSOLE_ENABLE = yes
+    OPT_DEFS += -DKEY_TRACE_ENABLE
+    SRC += features/key_trace.c
+endif
+
+# Press-gap histograms per combo, see features/combo_stats.h.
+COMBO_STATS_ENABLE ?= no
+ifeq ($(strip $(COMBO_STATS_ENABLE)), yes)
+    CONSOLE_ENABLE = yes
+    OPT_DEFS += -DCOMBO_STATS_ENABLE
+    SRC += features/combo_stats.c
+endif
+
+# Scan bench, an on-device tool timing the scan loop and key events, see
+# features/scan_bench.h.
+SCAN_BENCH_ENABLE ?= no
+ifeq ($(strip $(SCAN_BENCH_ENABLE)), yes)
+    CONSOLE_ENABLE = yes
+    OPT_DEFS += -DSCAN_BENCH_ENABLE
+    SRC += features/scan_bench.c
+endif
 
 
 
@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+"""Scan bench: compares on-device scan timings with a saved baseline.
+
+An on-device tool, not a benchmark suite, see features/scan_bench.h.
+
+Build with SCAN_BENCH_ENABLE=yes, flash, then type a fixed script, the same
+text on every layer to compare, while saving the `qmk console` output. The
+average of every report in the log is used, weighted by loops and scans.
+
+With --save the timings are written as the new baseline. With --baseline,
+every average timing more than --tolerance slower than the baseline is
+listed and the exit code is 1. Maximums are printed but not compared, a
+single interrupt can set them.
+
+No baseline is committed: save one from the board being compared, the
+numbers depend on it and on how the script was typed.
+
+Usage:
+  scan_bench.py log [--baseline JSON [--tolerance 0.1]] [--save JSON]
+"""
+
+import argparse
+import json
+import re
+import sys
+
+
+def parse(path):
+    boot_us, loop, layers, idle_wake_bound_ms = None, [0, 0, 0], {}, 0
+    with open(path, errors="replace") as f:
+        for line in f:
+            match = re.search(r"bench boot_us (\d+) loop_us (\d+) (\d+) (\d+) loops (\d+)", line)
+            if match:
+                boot_us = int(match.group(1))
+                avg, peak, count = int(match.group(3)), int(match.group(4)), int(match.group(5))
+                loop = [loop[0] + avg * count, max(loop[1], peak), loop[2] + count]
+                continue
+            match = re.search(r"bench layer (\d+) scans (\d+) us (\d+) (\d+)", line)
+            if match:
+                layer, count, avg, peak = (int(n) for n in match.groups())
+                total = layers.setdefault(layer, [0, 0, 0])
+                layers[layer] = [total[0] + avg * count, max(total[1], peak), total[2] + count]
+                continue
+            match = re.search(r"bench idle_wake_bound_ms (\d+)", line)
+            if match:
+                idle_wake_bound_ms = max(idle_wake_bound_ms, int(match.group(1)))
+    if boot_us is None:
+        sys.exit(f"no bench report in {path}")
+
+    def average(total):
+        return {"avg": total[0] // total[2] if total[2] else 0, "max": total[1], "count": total[2]}
+
+    return {
+        "boot_us": boot_us,
+        "loop_us": average(loop),
+        "layers": {str(layer): average(total) for layer, total in sorted(layers.items())},
+        "idle_wake_bound_ms": idle_wake_bound_ms,
+    }
+
+
+def slower(results, baseline, tolerance):
+    failures = []
+
+    def check(name, value, base):
+        if base and value > base * (1 + tolerance):
+            failures.append(f"{name}: {value} us > {base} us")
+
+    check("boot", results["boot_us"], baseline.get("boot_us"))
+    check("loop", results["loop_us"]["avg"], baseline.get("loop_us", {}).get("avg"))
+    for layer, timing in results["layers"].items():
+        check(f"layer {layer}", timing["avg"], baseline.get("layers", {}).get(layer, {}).get("avg"))
+    return failures
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("log")
+    parser.add_argument("--baseline", help="JSON saved by --save")
+    parser.add_argument("--tolerance", type=float, default=0.1, help="accepted slowdown over the baseline")
+    parser.add_argument("--save", help="write the timings to this JSON")
+    args = parser.parse_args()
+
+    results = parse(args.log)
+    print(f"{'':<12}{'avg us':>8}{'max us':>8}{'count':>8}")
+    print(f"{'boot':<12}{results['boot_us']:>8}")
+    for name, timing in [("loop", results["loop_us"])] + [(f"layer {l}", t) for l, t in results["layers"].items()]:
+        print(f"{name:<12}{timing['avg']:>8}{timing['max']:>8}{timing['count']:>8}")
+    print(f"longest a press could wait to be scanned in the idle slow stage: {results['idle_wake_bound_ms']} ms")
+
+    if args.save:
+        with open(args.save, "w") as f:
+            json.dump(results, f, indent=2, sort_keys=True)
+            f.write("\n")
+
+    if args.baseline:
+        with open(args.baseline) as f:
+            failures = slower(results, json.load(f), args.tolerance)
+        for failure in failures:
+            print("slower: " + failure, file=sys.stderr)
+        if failures:
+            sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
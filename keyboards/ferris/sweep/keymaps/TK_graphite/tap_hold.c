@@ -0,0 +1,56 @@
+#include "keycodes.h"
+#include "features/achordion.h"
+#include "features/typing_speed.h"
+
+//////////////////////////////// TAP-HOLD /////////////////////////////////////
+uint16_t get_tapping_term(uint16_t keycode, keyrecord_t* record)
+{
+    switch(keycode)
+    {
+    case LGUI_T(KC_R):
+    case RGUI_T(KC_E):
+        return TAPPING_TERM + 100;
+    default:
+        return TAPPING_TERM;
+    }
+}
+
+
+//////////////////////////////// ACHORDION ////////////////////////////////////
+
+bool achordion_chord(uint16_t tap_hold_keycode,
+                     keyrecord_t* tap_hold_record,
+                     uint16_t other_keycode,
+                     keyrecord_t* other_record)
+{
+    // Mods chorded with the thumb layers, e.g. Ctrl + arrows on NAV_LAYER.
+    if(other_keycode == NAV_HOLD || other_keycode == SYM_WIN_LAYER)
+        return true;
+    if(other_keycode == OSM(MOD_LSFT))
+        return true;
+    return achordion_opposite_hands(tap_hold_record, other_record);
+}
+
+uint16_t achordion_timeout(uint16_t tap_hold_keycode)
+{
+    return 800;
+}
+
+bool achordion_eager_mod(uint8_t mod)
+{
+    // All mods, MEH included. Achordion masks Alt and GUI when it rolls them back.
+    // Not while typing fast though, a mod-tap is then most likely a letter.
+    return typing_speed_wpm() < 60;
+}
+uint16_t achordion_streak_timeout(uint16_t tap_hold_keycode)
+{
+    if(IS_QK_LAYER_TAP(tap_hold_keycode))
+    {
+        return 0;  // Disable streak detection on layer-tap keys.
+    }
+
+    // Otherwise, tap_hold_keycode is a mod-tap key. The streak outlasts the
+    // gaps of a fast burst, but never blocks a hold for long.
+    const uint16_t interval = typing_speed_interval();
+    return MIN(MAX(interval * 3 / 2, 100), 150);
+}
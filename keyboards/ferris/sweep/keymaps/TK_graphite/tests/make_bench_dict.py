@@ -0,0 +1,51 @@
+#!/usr/bin/env python3
+"""Generates a text expansion dictionary of COUNT entries for the benchmark.
+
+Words are drawn from English letter frequencies and each typo swaps two
+neighbouring letters, half of them matched as whole words, half as word
+starts. A word start never begins another typo, which it would cut short.
+The output is the same for the same COUNT.
+
+Usage:
+  make_bench_dict.py COUNT -o dict
+"""
+
+import argparse
+import random
+
+LETTERS = "etaoinshrdlcumwfgypbvkjxqz"
+WEIGHTS = [127, 91, 82, 75, 70, 67, 63, 61, 60, 43, 40, 28, 28, 24, 24, 22, 20, 20, 19, 15, 10, 8, 2, 2, 1, 1]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("count", type=int)
+    parser.add_argument("-o", "--output", required=True)
+    args = parser.parse_args()
+
+    rng = random.Random(args.count)
+    typos = set()
+    starts = set()  # Typos matched as word starts.
+    prefixes = set()  # Every prefix of every typo.
+    with open(args.output, "w") as f:
+        f.write(f"# {args.count} generated entries, see make_bench_dict.py.\n")
+        while len(typos) < args.count:
+            word = "".join(rng.choices(LETTERS, WEIGHTS, k=rng.randint(4, 10)))
+            swap = rng.randrange(len(word) - 1)
+            typo = word[:swap] + word[swap + 1] + word[swap] + word[swap + 2:]
+            typo = ":" + typo + (":" if rng.random() < 0.5 else "")
+            if typo.strip(":") == word or typo in typos:
+                continue
+            if any(typo[:end] in starts for end in range(2, len(typo) + 1)):
+                continue
+            if not typo.endswith(":") and typo in prefixes:
+                continue
+            typos.add(typo)
+            prefixes.update(typo[:end] for end in range(2, len(typo) + 1))
+            if not typo.endswith(":"):
+                starts.add(typo)
+            f.write(f"{typo:<16} -> {word}\n")
+
+
+if __name__ == "__main__":
+    main()
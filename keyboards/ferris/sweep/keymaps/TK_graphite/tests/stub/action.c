@@ -0,0 +1,699 @@
+#include "quantum.h"
+
+// QMK's keyboard core, for host builds of the whole keymap: the keymap lookup
+// with its layer cache, combos, tap-hold, key overrides and the actions of
+// the keycodes. It models QMK closely enough for the keymap, it is not QMK:
+//
+//  * pre_process_record_user() sees every physical event first, then the
+//    combos, then tap-hold, then key overrides, process_record_user() and
+//    the action of the keycode.
+//  * A combo fires once all its keys are down within its term, and releases
+//    with the first of them. Another key, a release or the term running out
+//    passes the keys held back on.
+//  * Tap-hold keys, mod-taps, layer-taps and one-shot mods, are a tap when
+//    released within the tapping term. They are a hold once the term runs
+//    out or, with PERMISSIVE_HOLD, a key pressed after them is released.
+//    Events behind an undecided key wait, releases of keys pressed before
+//    it don't.
+//  * A key override sends its replacement through process_record() with the
+//    keycode set, so custom keycodes work as replacements. It ends with the
+//    release of its trigger.
+//  * Caps Word, tap dance, auto shift and NKRO are not modelled.
+
+#define COMBO_BUFFER   4
+#define WAITING_BUFFER 16
+
+uint32_t stub_layers_pressed;
+uint32_t stub_combos_completed;
+uint32_t stub_overrides_fired;
+uint64_t stub_custom_keycodes;
+
+static matrix_row_t matrix[MATRIX_ROWS];
+static matrix_row_t previous_matrix[MATRIX_ROWS];
+static uint32_t last_activity;
+// Layer each key was pressed on, its release uses the same.
+static uint8_t source_layers[MATRIX_ROWS][MATRIX_COLS];
+// Tap count of each key's last press, its release gets the same.
+static uint8_t tap_counts[MATRIX_ROWS][MATRIX_COLS];
+
+static void tapping_process(keyrecord_t* record);
+
+//////////////////////////////// KEYMAP ///////////////////////////////////////
+// QMK stores five-bit mods in keycodes, bit 4 selecting the right-hand ones.
+static uint8_t mods_from_keycode(uint8_t mods)
+{
+    return (mods & 0x10) ? (uint8_t)((mods & 0x0F) << 4) : mods;
+}
+
+static uint8_t layer_for(keypos_t key)
+{
+    const layer_state_t layers = layer_state | default_layer_state;
+    for(int8_t layer = keymap_layer_count() - 1; layer > 0; layer--)
+    {
+        if((layers >> layer) & 1 && keycode_at_keymap_location(layer, key.row, key.col) != KC_TRNS)
+        {
+            return layer;
+        }
+    }
+    return 0;
+}
+
+// A press looks its key up on the layers on now, a release on the layer of
+// its press.
+static uint16_t record_keycode(keyrecord_t* record)
+{
+    if(record->keycode || !IS_KEYEVENT(record->event))
+    {
+        return record->keycode;
+    }
+    const keypos_t key = record->event.key;
+    if(record->event.pressed)
+    {
+        source_layers[key.row][key.col] = layer_for(key);
+    }
+    return keycode_at_keymap_location(source_layers[key.row][key.col], key.row, key.col);
+}
+
+static bool is_tap_hold(uint16_t keycode)
+{
+    return IS_QK_MOD_TAP(keycode) || IS_QK_LAYER_TAP(keycode) || IS_QK_ONE_SHOT_MOD(keycode);
+}
+
+//////////////////////////////// ACTIONS //////////////////////////////////////
+static report_mouse_t mouse;
+
+report_mouse_t mousekey_get_report(void)
+{
+    return mouse;
+}
+
+static void mousekey(uint16_t keycode, bool pressed)
+{
+    const int8_t step = pressed ? 1 : 0;
+    switch(keycode)
+    {
+    case KC_MS_BTN1:
+    case KC_MS_BTN2:
+    case KC_MS_BTN3:
+    {
+        const uint8_t button = 1 << (keycode - KC_MS_BTN1);
+        mouse.buttons        = pressed ? mouse.buttons | button : mouse.buttons & ~button;
+        break;
+    }
+    case KC_MS_WH_UP:
+        mouse.v = step;
+        break;
+    case KC_MS_WH_DOWN:
+        mouse.v = -step;
+        break;
+    case KC_MS_WH_LEFT:
+        mouse.h = -step;
+        break;
+    case KC_MS_WH_RIGHT:
+        mouse.h = step;
+        break;
+    default:
+        return;  // Pointer motion is the keymap's, see features/mouse_motion.h.
+    }
+    host_mouse_send(&mouse);
+}
+
+static uint16_t consumer_usage(uint16_t keycode)
+{
+    switch(keycode)
+    {
+    case KC_AUDIO_MUTE:
+        return 0xE2;
+    case KC_AUDIO_VOL_UP:
+        return 0xE9;
+    case KC_AUDIO_VOL_DOWN:
+        return 0xEA;
+    case KC_MEDIA_NEXT_TRACK:
+        return 0xB5;
+    case KC_MEDIA_PREV_TRACK:
+        return 0xB6;
+    case KC_MEDIA_STOP:
+        return 0xB7;
+    default:
+        return 0xCD;  // KC_MEDIA_PLAY_PAUSE
+    }
+}
+
+static void release_override_mods(uint8_t mods);
+
+static void process_action(uint16_t keycode, keyrecord_t* record)
+{
+    const bool pressed = record->event.pressed;
+    const bool tap     = record->tap.count > 0;
+    if(IS_QK_MOD_TAP(keycode) && tap)
+    {
+        keycode = QK_MOD_TAP_GET_TAP_KEYCODE(keycode);
+    }
+    else if(IS_QK_MOD_TAP(keycode))
+    {
+        const uint8_t mods = mods_from_keycode(QK_MOD_TAP_GET_MODS(keycode));
+        if(pressed)
+        {
+            register_mods(mods);
+        }
+        else
+        {
+            release_override_mods(mods);
+            unregister_mods(mods);
+        }
+        return;
+    }
+    else if(IS_QK_LAYER_TAP(keycode) && tap)
+    {
+        keycode = QK_LAYER_TAP_GET_TAP_KEYCODE(keycode);
+    }
+    else if(IS_QK_LAYER_TAP(keycode))
+    {
+        if(pressed)
+        {
+            layer_on(QK_LAYER_TAP_GET_LAYER(keycode));
+        }
+        else
+        {
+            layer_off(QK_LAYER_TAP_GET_LAYER(keycode));
+        }
+        return;
+    }
+    else if(IS_QK_ONE_SHOT_MOD(keycode))
+    {
+        const uint8_t mods = mods_from_keycode(QK_ONE_SHOT_MOD_GET_MODS(keycode));
+        if(tap)
+        {
+            if(pressed)
+            {
+                add_oneshot_mods(mods);
+            }
+        }
+        else if(pressed)
+        {
+            register_mods(mods | get_oneshot_mods());
+        }
+        else
+        {
+            clear_oneshot_mods();
+            release_override_mods(mods);
+            unregister_mods(mods);
+        }
+        return;
+    }
+
+    if(IS_QK_TO(keycode))
+    {
+        if(pressed)
+        {
+            layer_move(QK_TO_GET_LAYER(keycode));
+        }
+        return;
+    }
+    if(IS_MEDIA_KEYCODE(keycode))
+    {
+        host_consumer_send(pressed ? consumer_usage(keycode) : 0);
+        return;
+    }
+    if(IS_MOUSE_KEYCODE(keycode))
+    {
+        mousekey(keycode, pressed);
+        return;
+    }
+    if(pressed)
+    {
+        switch(keycode)
+        {
+        case QK_BOOT:
+            reset_keyboard();
+            return;
+        case QK_RBT:
+            soft_reset_keyboard();
+            return;
+        case EE_CLR:
+            eeconfig_init();
+            return;
+        case UG_TOGG:
+            rgblight_toggle();
+            return;
+        }
+    }
+    if(keycode == KC_NO || keycode > QK_MODS_MAX)
+    {
+        return;
+    }
+    if(pressed)
+    {
+        register_code16(keycode);
+    }
+    else
+    {
+        unregister_code16(keycode);
+    }
+}
+
+//////////////////////////////// KEY OVERRIDES ////////////////////////////////
+static const key_override_t* active_override = NULL;
+static keypos_t override_key;
+// Mods the active override took away that are still held.
+static uint8_t suppressed = 0;
+
+static void release_override_mods(uint8_t mods)
+{
+    suppressed &= ~mods;
+}
+
+// QMK takes either side of a mod for the trigger mods.
+static bool mods_match(uint8_t mods, uint8_t wanted)
+{
+    for(uint8_t bit = 0; bit < 4; bit++)
+    {
+        const uint8_t both = (1 << bit) | (1 << (bit + 4));
+        if((wanted & both) && !(mods & both))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void send_replacement(uint16_t keycode, bool pressed)
+{
+    keyrecord_t record = {.event = MAKE_COMBOEVENT(pressed), .keycode = keycode};
+    process_record(&record);
+}
+
+static void end_override(void)
+{
+    const key_override_t* override = active_override;
+    active_override                = NULL;
+    send_replacement(override->replacement, false);
+    add_mods(suppressed);
+    suppressed = 0;
+    send_keyboard_report();
+}
+
+static bool process_key_override(uint16_t keycode, keyrecord_t* record)
+{
+    if(!IS_KEYEVENT(record->event))
+    {
+        return true;
+    }
+    if(!record->event.pressed)
+    {
+        if(active_override && KEYEQ(record->event.key, override_key))
+        {
+            end_override();
+            return false;
+        }
+        return true;
+    }
+
+    const uint8_t mods  = get_mods() | get_oneshot_mods();
+    const uint8_t layer = get_highest_layer(layer_state | default_layer_state);
+    for(uint16_t i = 0; i < key_override_count(); i++)
+    {
+        const key_override_t* override = key_override_get(i);
+        if(override->trigger != keycode || !((override->layers >> layer) & 1) || !mods_match(mods, override->trigger_mods))
+        {
+            continue;
+        }
+        if(active_override)
+        {
+            end_override();
+        }
+        stub_overrides_fired |= (uint32_t)1 << i;
+        active_override = override;
+        override_key    = record->event.key;
+        suppressed      = get_mods() & override->suppressed_mods;
+        del_mods(override->suppressed_mods);
+        del_oneshot_mods(override->suppressed_mods);
+        send_replacement(override->replacement, true);
+        return false;
+    }
+    return true;
+}
+
+// QMK's process_record(), with the keycode of the event, or the one set on it.
+void process_record(keyrecord_t* record)
+{
+    const uint16_t keycode = record_keycode(record);
+    if(record->event.pressed && keycode >= SAFE_RANGE && keycode < SAFE_RANGE + 64)
+    {
+        stub_custom_keycodes |= (uint64_t)1 << (keycode - SAFE_RANGE);
+    }
+    if(!process_key_override(keycode, record) || !process_record_user(keycode, record))
+    {
+        return;
+    }
+    process_action(keycode, record);
+}
+
+//////////////////////////////// TAP-HOLD /////////////////////////////////////
+static bool tapping = false;
+static keyrecord_t tapping_key;
+static keyrecord_t waiting[WAITING_BUFFER];
+static uint8_t waiting_count = 0;
+
+static void dispatch(keyrecord_t* record)
+{
+    if(IS_KEYEVENT(record->event))
+    {
+        const keypos_t key = record->event.key;
+        if(record->event.pressed)
+        {
+            tap_counts[key.row][key.col] = record->tap.count;
+        }
+        record->tap.count = tap_counts[key.row][key.col];
+    }
+    process_record(record);
+}
+
+static void flush_waiting(void)
+{
+    keyrecord_t queued[WAITING_BUFFER];
+    const uint8_t count = waiting_count;
+    memcpy(queued, waiting, count * sizeof(*queued));
+    waiting_count = 0;
+    for(uint8_t i = 0; i < count; i++)
+    {
+        tapping_process(&queued[i]);
+    }
+}
+
+static void settle(uint8_t count)
+{
+    tapping               = false;
+    tapping_key.tap.count = count;
+    dispatch(&tapping_key);
+}
+
+static bool term_expired(uint16_t time)
+{
+    const uint16_t keycode = record_keycode(&tapping_key);
+    return TIMER_DIFF_16(time, tapping_key.event.time) >= get_tapping_term(keycode, &tapping_key);
+}
+
+static bool is_waiting(keypos_t key)
+{
+    for(uint8_t i = 0; i < waiting_count; i++)
+    {
+        if(waiting[i].event.pressed && KEYEQ(waiting[i].event.key, key))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void tapping_process(keyrecord_t* record)
+{
+    if(tapping && term_expired(record->event.time))
+    {
+        settle(0);
+        flush_waiting();
+    }
+    if(!tapping)
+    {
+        if(record->event.pressed && is_tap_hold(record_keycode(record)))
+        {
+            tapping     = true;
+            tapping_key = *record;
+            return;
+        }
+        dispatch(record);
+        return;
+    }
+
+    if(!record->event.pressed && KEYEQ(record->event.key, tapping_key.event.key))
+    {
+        // Released within the tapping term, a tap. The keys behind it follow.
+        settle(1);
+        dispatch(record);
+        flush_waiting();
+        return;
+    }
+    if(!record->event.pressed && !is_waiting(record->event.key))
+    {
+        dispatch(record);  // Pressed before the tap-hold key.
+        return;
+    }
+    if(waiting_count == WAITING_BUFFER)
+    {
+        settle(0);
+        flush_waiting();
+        tapping_process(record);
+        return;
+    }
+    waiting[waiting_count++] = *record;
+    if(!record->event.pressed)
+    {
+        // PERMISSIVE_HOLD: a key tapped within the hold.
+        settle(0);
+        flush_waiting();
+    }
+}
+
+static void tapping_task(void)
+{
+    if(tapping && term_expired(timer_read() | 1))
+    {
+        settle(0);
+        flush_waiting();
+    }
+}
+
+//////////////////////////////// COMBOS ///////////////////////////////////////
+static keyrecord_t combo_buffer[COMBO_BUFFER];
+static uint8_t combo_buffered = 0;
+// Combo each key is held down for, or -1.
+static int8_t combo_of_key[MATRIX_ROWS][MATRIX_COLS];
+static uint32_t combos_active = 0;
+
+static bool combo_has(const combo_t* combo, uint16_t keycode)
+{
+    for(const uint16_t* key = combo->keys; *key != COMBO_END; key++)
+    {
+        if(*key == keycode)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint8_t combo_size(const combo_t* combo)
+{
+    uint8_t size = 0;
+    while(combo->keys[size] != COMBO_END)
+    {
+        size++;
+    }
+    return size;
+}
+
+// A combo with all the keys held back, that may still complete.
+static bool combo_possible(const combo_t* combo)
+{
+    for(uint8_t i = 0; i < combo_buffered; i++)
+    {
+        if(!combo_has(combo, record_keycode(&combo_buffer[i])))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool is_combo_key(uint16_t keycode)
+{
+    for(uint16_t i = 0; i < combo_count(); i++)
+    {
+        if(combo_has(combo_get(i), keycode))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void combo_dump(void)
+{
+    keyrecord_t held[COMBO_BUFFER];
+    const uint8_t count = combo_buffered;
+    memcpy(held, combo_buffer, count * sizeof(*held));
+    combo_buffered = 0;
+    for(uint8_t i = 0; i < count; i++)
+    {
+        tapping_process(&held[i]);
+    }
+}
+
+static bool combo_expired(uint16_t time)
+{
+    uint16_t term = 0;
+    for(uint16_t i = 0; i < combo_count(); i++)
+    {
+        if(combo_possible(combo_get(i)))
+        {
+            term = MAX(term, get_combo_term(i, combo_get(i)));
+        }
+    }
+    return TIMER_DIFF_16(time, combo_buffer[0].event.time) > term;
+}
+
+static void combo_fire(uint16_t index)
+{
+    for(uint8_t i = 0; i < combo_buffered; i++)
+    {
+        combo_of_key[combo_buffer[i].event.key.row][combo_buffer[i].event.key.col] = index;
+    }
+    combo_buffered = 0;
+    combos_active |= (uint32_t)1 << index;
+    keyrecord_t record = {.event = MAKE_COMBOEVENT(true), .keycode = combo_get(index)->keycode};
+    tapping_process(&record);
+}
+
+// Returns whether the combos took the event.
+static bool combo_process(keyrecord_t* record)
+{
+    const keypos_t key = record->event.key;
+    if(combo_buffered && combo_expired(record->event.time))
+    {
+        combo_dump();
+    }
+    if(!record->event.pressed)
+    {
+        const int8_t index = combo_of_key[key.row][key.col];
+        if(index < 0)
+        {
+            combo_dump();
+            return false;
+        }
+        combo_of_key[key.row][key.col] = -1;
+        if(combos_active & ((uint32_t)1 << index))
+        {
+            combos_active &= ~((uint32_t)1 << index);
+            keyrecord_t release = {.event = MAKE_COMBOEVENT(false), .keycode = combo_get(index)->keycode};
+            tapping_process(&release);
+        }
+        return true;
+    }
+
+    const uint16_t keycode = record_keycode(record);
+    if(!is_combo_key(keycode))
+    {
+        combo_dump();
+        return false;
+    }
+    if(combo_buffered == COMBO_BUFFER)
+    {
+        combo_dump();
+    }
+    combo_buffer[combo_buffered++] = *record;
+    bool possible                  = false;
+    for(uint16_t i = 0; i < combo_count(); i++)
+    {
+        combo_t* combo = combo_get(i);
+        if(!combo_possible(combo))
+        {
+            continue;
+        }
+        possible = true;
+        if(combo_size(combo) == combo_buffered)
+        {
+            stub_combos_completed |= (uint32_t)1 << i;
+            if(combo_should_trigger(i, combo, keycode, record))
+            {
+                combo_fire(i);
+                return true;
+            }
+        }
+    }
+    if(!possible)
+    {
+        // Pass the keys before on, this one may start another combo.
+        combo_buffered--;
+        combo_dump();
+        combo_buffer[combo_buffered++] = *record;
+    }
+    return true;
+}
+
+static void combo_task(void)
+{
+    if(combo_buffered && combo_expired(timer_read() | 1))
+    {
+        combo_dump();
+    }
+}
+
+//////////////////////////////// KEYBOARD TASK ////////////////////////////////
+matrix_row_t matrix_get_row(uint8_t row)
+{
+    return matrix[row];
+}
+
+void stub_matrix_set(uint8_t row, uint8_t col, bool pressed)
+{
+    if(pressed)
+    {
+        matrix[row] |= 1 << col;
+    }
+    else
+    {
+        matrix[row] &= ~(1 << col);
+    }
+}
+
+static void action_exec(keyevent_t event)
+{
+    keyrecord_t record     = {.event = event};
+    const uint16_t keycode = record_keycode(&record);
+    if(event.pressed)
+    {
+        stub_layers_pressed |= (uint32_t)1 << source_layers[event.key.row][event.key.col];
+    }
+    if(!pre_process_record_user(keycode, &record) || combo_process(&record))
+    {
+        return;
+    }
+    tapping_process(&record);
+}
+
+void stub_keyboard_init(void)
+{
+    memset(matrix, 0, sizeof(matrix));
+    memset(previous_matrix, 0, sizeof(previous_matrix));
+    memset(combo_of_key, -1, sizeof(combo_of_key));
+    last_activity = stub_now;
+    if(combo_count() > 32 || key_override_count() > 32 || keymap_layer_count() > 32)
+    {
+        fprintf(stderr, "stub/action.c: more than 32 combos, key overrides or layers\n");
+    }
+    keyboard_pre_init_user();
+    keyboard_post_init_user();
+}
+
+void stub_keyboard_task(void)
+{
+    matrix_scan_user();
+    for(uint8_t row = 0; row < MATRIX_ROWS; row++)
+    {
+        const matrix_row_t changes = matrix[row] ^ previous_matrix[row];
+        for(uint8_t col = 0; col < MATRIX_COLS; col++)
+        {
+            if(changes & (1 << col))
+            {
+                const bool pressed = matrix[row] & (1 << col);
+                action_exec((keyevent_t){.key = {col, row}, .time = timer_read() | 1, .type = KEY_EVENT, .pressed = pressed});
+                last_activity = stub_now;
+            }
+        }
+        previous_matrix[row] = matrix[row];
+    }
+    tapping_task();
+    combo_task();
+    stub_idle_ms = stub_now - last_activity;
+    housekeeping_task_user();
+}
@@ -0,0 +1,4 @@
+#pragma once
+
+// Nothing interrupts the host tests, the block just runs once.
+#define ATOMIC_BLOCK_FORCEON for(int atomic_once_ = 1; atomic_once_; atomic_once_ = 0)
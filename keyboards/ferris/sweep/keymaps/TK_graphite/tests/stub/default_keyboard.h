@@ -0,0 +1,21 @@
+#pragma once
+
+// QMK_KEYBOARD_H of the host build. Rows 0 to 3 are the left half, 4 to 7 the
+// right, columns run left to right and the thumbs are the first two columns
+// of the last row of each half, as the other tests lay out the keys.
+
+#include "quantum.h"
+
+// clang-format off
+#define LAYOUT_split_3x5_2(                                            \
+    L00, L01, L02, L03, L04,  R00, R01, R02, R03, R04,                 \
+    L10, L11, L12, L13, L14,  R10, R11, R12, R13, R14,                 \
+    L20, L21, L22, L23, L24,  R20, R21, R22, R23, R24,                 \
+                    L30, L31,  R30, R31)                               \
+    {                                                                  \
+        {L00, L01, L02, L03, L04}, {L10, L11, L12, L13, L14},          \
+        {L20, L21, L22, L23, L24}, {L30, L31, KC_NO, KC_NO, KC_NO},    \
+        {R00, R01, R02, R03, R04}, {R10, R11, R12, R13, R14},          \
+        {R20, R21, R22, R23, R24}, {R30, R31, KC_NO, KC_NO, KC_NO},    \
+    }
+// clang-format on
@@ -0,0 +1,46 @@
+#pragma once
+
+// QMK's host driver, the last step of a report on its way to USB. The stub's
+// driver logs the reports, see stub.h.
+
+#include <stdint.h>
+
+#define KEYBOARD_REPORT_KEYS 6
+
+typedef struct
+{
+    uint8_t mods;
+    uint8_t reserved;
+    uint8_t keys[KEYBOARD_REPORT_KEYS];
+} report_keyboard_t;
+
+typedef struct
+{
+    uint8_t buttons;
+    int8_t x;
+    int8_t y;
+    int8_t v;
+    int8_t h;
+} report_mouse_t;
+
+#define REPORT_ID_CONSUMER 3
+
+typedef struct
+{
+    uint8_t report_id;
+    uint16_t usage;
+} report_extra_t;
+
+typedef struct
+{
+    uint8_t (*keyboard_leds)(void);
+    void (*send_keyboard)(report_keyboard_t* report);
+    void (*send_nkro)(void* report);
+    void (*send_mouse)(report_mouse_t* report);
+    void (*send_extra)(report_extra_t* report);
+} host_driver_t;
+
+void host_set_driver(host_driver_t* driver);
+host_driver_t* host_get_driver(void);
+void host_mouse_send(report_mouse_t* report);
+void host_consumer_send(uint16_t usage);
@@ -0,0 +1,17 @@
+#pragma once
+
+// The keycodes of QMK's keymap_us_international.h that the keymap uses.
+
+#include "quantum.h"
+
+#define US_AACU ALGR(KC_A)
+#define US_EACU ALGR(KC_E)
+#define US_IACU ALGR(KC_I)
+#define US_OACU ALGR(KC_O)
+#define US_UACU ALGR(KC_U)
+#define US_ADIA ALGR(KC_Q)
+#define US_ODIA ALGR(KC_P)
+#define US_UDIA ALGR(KC_Y)
+#define US_AE   ALGR(KC_Z)
+#define US_SS   ALGR(KC_S)
+#define US_CCED ALGR(KC_COMM)
@@ -0,0 +1,466 @@
+#pragma once
+
+// Minimal stand-in for QMK's quantum.h, just enough to build the feature
+// modules on the host. Keycodes and masks use QMK's values. Time is a fake
+// clock advanced by the tests, and every keyboard report is logged so tests
+// can compare what the host would have seen.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define SPLIT_KEYBOARD
+#define MATRIX_ROWS 8
+#define MATRIX_COLS 5
+
+#ifndef TAPPING_TERM
+#define TAPPING_TERM 300
+#endif
+#ifndef TAP_CODE_DELAY
+#define TAP_CODE_DELAY 0
+#endif
+#ifndef MAX_DEFERRED_EXECUTORS
+#define MAX_DEFERRED_EXECUTORS 8
+#endif
+#ifndef EECONFIG_USER_DATA_SIZE
+#define EECONFIG_USER_DATA_SIZE 0
+#endif
+#define MAX_LAYER 16
+
+#define PROGMEM
+#define ARRAY_SIZE(array) (sizeof(array) / sizeof((array)[0]))
+#ifndef MIN
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#endif
+#ifndef MAX
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#endif
+
+#define dprint(...)   ((void)0)
+#define dprintln(...) ((void)0)
+#define dprintf(...)  ((void)0)
+#define uprintf(...)  ((void)0)
+
+//////////////////////////////// KEYCODES /////////////////////////////////////
+enum
+{
+    KC_NO   = 0x00,
+    KC_TRANSPARENT = 0x01,
+    KC_A    = 0x04,
+    KC_B, KC_C, KC_D, KC_E, KC_F, KC_G, KC_H, KC_I, KC_J, KC_K, KC_L, KC_M,
+    KC_N, KC_O, KC_P, KC_Q, KC_R, KC_S, KC_T, KC_U, KC_V, KC_W, KC_X, KC_Y,
+    KC_Z,
+    KC_1    = 0x1E,
+    KC_2, KC_3, KC_4, KC_5, KC_6, KC_7, KC_8, KC_9, KC_0,
+    KC_ENT  = 0x28,
+    KC_ESC  = 0x29,
+    KC_BSPC = 0x2A,
+    KC_TAB  = 0x2B,
+    KC_SPC  = 0x2C,
+    KC_MINS = 0x2D,
+    KC_EQL  = 0x2E,
+    KC_LBRC = 0x2F,
+    KC_RBRC = 0x30,
+    KC_BSLS = 0x31,
+    KC_SCLN = 0x33,
+    KC_QUOT = 0x34,
+    KC_GRV  = 0x35,
+    KC_COMM = 0x36,
+    KC_DOT  = 0x37,
+    KC_SLSH = 0x38,
+    KC_F1   = 0x3A,
+    KC_F2, KC_F3, KC_F4, KC_F5, KC_F6, KC_F7, KC_F8, KC_F9, KC_F10, KC_F11,
+    KC_F12,
+    KC_PGDN = 0x4E,
+    KC_RGHT = 0x4F,
+    KC_LEFT = 0x50,
+    KC_DOWN = 0x51,
+    KC_UP   = 0x52,
+    KC_KP_SLASH = 0x54,
+    KC_KP_ASTERISK, KC_KP_MINUS, KC_KP_PLUS, KC_KP_ENTER,
+    KC_KP_1 = 0x59,
+    KC_KP_2, KC_KP_3, KC_KP_4, KC_KP_5, KC_KP_6, KC_KP_7, KC_KP_8, KC_KP_9,
+    KC_KP_0,
+    KC_F24  = 0x73,
+    KC_AUDIO_MUTE = 0xA8,
+    KC_AUDIO_VOL_UP, KC_AUDIO_VOL_DOWN, KC_MEDIA_NEXT_TRACK, KC_MEDIA_PREV_TRACK,
+    KC_MEDIA_STOP, KC_MEDIA_PLAY_PAUSE,
+    KC_MS_UP = 0xCD,
+    KC_MS_DOWN, KC_MS_LEFT, KC_MS_RIGHT, KC_MS_BTN1, KC_MS_BTN2, KC_MS_BTN3,
+    KC_MS_BTN4, KC_MS_BTN5, KC_MS_BTN6, KC_MS_BTN7, KC_MS_BTN8, KC_MS_WH_UP,
+    KC_MS_WH_DOWN, KC_MS_WH_LEFT, KC_MS_WH_RIGHT, KC_MS_ACCEL0, KC_MS_ACCEL1,
+    KC_MS_ACCEL2,
+    KC_LCTL = 0xE0,
+    KC_LSFT, KC_LALT, KC_LGUI, KC_RCTL, KC_RSFT, KC_RALT, KC_RGUI,
+};
+#define KC_ENTER KC_ENT
+#define KC_TRNS  KC_TRANSPARENT
+#define KC_PSLS  KC_KP_SLASH
+#define KC_PAST  KC_KP_ASTERISK
+#define KC_PMNS  KC_KP_MINUS
+#define KC_PPLS  KC_KP_PLUS
+#define KC_P1    KC_KP_1
+#define KC_P2    KC_KP_2
+#define KC_P3    KC_KP_3
+#define KC_P4    KC_KP_4
+#define KC_P5    KC_KP_5
+#define KC_P6    KC_KP_6
+#define KC_P7    KC_KP_7
+#define KC_P8    KC_KP_8
+#define KC_P9    KC_KP_9
+#define KC_P0    KC_KP_0
+#define KC_MUTE  KC_AUDIO_MUTE
+#define KC_VOLU  KC_AUDIO_VOL_UP
+#define KC_VOLD  KC_AUDIO_VOL_DOWN
+#define KC_MNXT  KC_MEDIA_NEXT_TRACK
+#define KC_MPRV  KC_MEDIA_PREV_TRACK
+#define KC_MPLY  KC_MEDIA_PLAY_PAUSE
+#define KC_MS_U  KC_MS_UP
+#define KC_MS_D  KC_MS_DOWN
+#define KC_MS_L  KC_MS_LEFT
+#define KC_MS_R  KC_MS_RIGHT
+#define KC_WH_U  KC_MS_WH_UP
+#define KC_WH_D  KC_MS_WH_DOWN
+#define KC_WH_L  KC_MS_WH_LEFT
+#define KC_WH_R  KC_MS_WH_RIGHT
+#define KC_ACL0  KC_MS_ACCEL0
+
+#define QK_BASIC_MAX           0x00FF
+#define QK_MODS                0x0100
+#define QK_MODS_MAX            0x1FFF
+#define QK_MOD_TAP             0x2000
+#define QK_MOD_TAP_MAX         0x3FFF
+#define QK_LAYER_TAP           0x4000
+#define QK_LAYER_TAP_MAX       0x4FFF
+#define QK_LAYER_MOD           0x5000
+#define QK_LAYER_MOD_MAX       0x51FF
+#define QK_TO                  0x5200
+#define QK_TO_MAX              0x521F
+#define QK_MOMENTARY           0x5220
+#define QK_MOMENTARY_MAX       0x523F
+#define QK_DEF_LAYER           0x5240
+#define QK_DEF_LAYER_MAX       0x525F
+#define QK_TOGGLE_LAYER        0x5260
+#define QK_TOGGLE_LAYER_MAX    0x527F
+#define QK_ONE_SHOT_LAYER      0x5280
+#define QK_ONE_SHOT_LAYER_MAX  0x529F
+#define QK_ONE_SHOT_MOD        0x52A0
+#define QK_ONE_SHOT_MOD_MAX    0x52BF
+#define QK_LAYER_TAP_TOGGLE    0x52C0
+#define QK_LAYER_TAP_TOGGLE_MAX 0x52DF
+#define QK_UNDERGLOW_TOGGLE    0x7820
+#define QK_BOOTLOADER          0x7C00
+#define QK_REBOOT              0x7C01
+#define QK_CLEAR_EEPROM        0x7C03
+#define SAFE_RANGE             0x7E40
+
+#define IS_QK_MODS(code)              ((code) >= QK_MODS && (code) <= QK_MODS_MAX)
+#define IS_QK_MOD_TAP(code)           ((code) >= QK_MOD_TAP && (code) <= QK_MOD_TAP_MAX)
+#define IS_QK_LAYER_TAP(code)         ((code) >= QK_LAYER_TAP && (code) <= QK_LAYER_TAP_MAX)
+#define IS_QK_LAYER_MOD(code)         ((code) >= QK_LAYER_MOD && (code) <= QK_LAYER_MOD_MAX)
+#define IS_QK_TO(code)                ((code) >= QK_TO && (code) <= QK_TO_MAX)
+#define IS_QK_MOMENTARY(code)         ((code) >= QK_MOMENTARY && (code) <= QK_MOMENTARY_MAX)
+#define IS_QK_DEF_LAYER(code)         ((code) >= QK_DEF_LAYER && (code) <= QK_DEF_LAYER_MAX)
+#define IS_QK_TOGGLE_LAYER(code)      ((code) >= QK_TOGGLE_LAYER && (code) <= QK_TOGGLE_LAYER_MAX)
+#define IS_QK_ONE_SHOT_LAYER(code)    ((code) >= QK_ONE_SHOT_LAYER && (code) <= QK_ONE_SHOT_LAYER_MAX)
+#define IS_QK_ONE_SHOT_MOD(code)      ((code) >= QK_ONE_SHOT_MOD && (code) <= QK_ONE_SHOT_MOD_MAX)
+#define IS_QK_LAYER_TAP_TOGGLE(code)  ((code) >= QK_LAYER_TAP_TOGGLE && (code) <= QK_LAYER_TAP_TOGGLE_MAX)
+#define IS_MODIFIER_KEYCODE(code)     ((code) >= KC_LCTL && (code) <= KC_RGUI)
+#define IS_BASIC_KEYCODE(code)        ((code) >= KC_A && (code) <= 0xA4)
+#define IS_MEDIA_KEYCODE(code)        ((code) >= KC_AUDIO_MUTE && (code) <= KC_MEDIA_PLAY_PAUSE)
+#define IS_MOUSE_KEYCODE(code)        ((code) >= KC_MS_UP && (code) <= KC_MS_ACCEL2)
+
+#define QK_MODS_GET_MODS(kc)             (((kc) >> 8) & 0x1F)
+#define QK_MODS_GET_BASIC_KEYCODE(kc)    ((kc) & 0xFF)
+#define QK_MOD_TAP_GET_MODS(kc)          (((kc) >> 8) & 0x1F)
+#define QK_MOD_TAP_GET_TAP_KEYCODE(kc)   ((kc) & 0xFF)
+#define QK_LAYER_TAP_GET_LAYER(kc)       (((kc) >> 8) & 0xF)
+#define QK_LAYER_TAP_GET_TAP_KEYCODE(kc) ((kc) & 0xFF)
+#define QK_TO_GET_LAYER(kc)              ((kc) & 0x1F)
+#define QK_ONE_SHOT_MOD_GET_MODS(kc)     ((kc) & 0x1F)
+
+#define MOD_LCTL 0x01
+#define MOD_LSFT 0x02
+#define MOD_LALT 0x04
+#define MOD_LGUI 0x08
+#define MOD_RCTL 0x11
+#define MOD_RSFT 0x12
+#define MOD_RALT 0x14
+#define MOD_RGUI 0x18
+#define MOD_MEH  (MOD_LCTL | MOD_LSFT | MOD_LALT)
+
+#define MOD_BIT(code)  (1 << ((code) & 0x07))
+#define MOD_MASK_CTRL  (MOD_BIT(KC_LCTL) | MOD_BIT(KC_RCTL))
+#define MOD_MASK_SHIFT (MOD_BIT(KC_LSFT) | MOD_BIT(KC_RSFT))
+#define MOD_MASK_ALT   (MOD_BIT(KC_LALT) | MOD_BIT(KC_RALT))
+#define MOD_MASK_GUI   (MOD_BIT(KC_LGUI) | MOD_BIT(KC_RGUI))
+
+#define LCTL(kc) (0x0100 | (kc))
+#define LSFT(kc) (0x0200 | (kc))
+#define LALT(kc) (0x0400 | (kc))
+#define LGUI(kc) (0x0800 | (kc))
+#define RCTL(kc) (0x1100 | (kc))
+#define RALT(kc) (0x1400 | (kc))
+#define ALGR(kc) RALT(kc)
+#define LSG(kc)  (0x0A00 | (kc))
+#define HYPR(kc) (0x0F00 | (kc))
+
+#define MT(mod, kc)   (QK_MOD_TAP | (((mod) & 0x1F) << 8) | ((kc) & 0xFF))
+#define LCTL_T(kc)    MT(MOD_LCTL, kc)
+#define LSFT_T(kc)    MT(MOD_LSFT, kc)
+#define LALT_T(kc)    MT(MOD_LALT, kc)
+#define LGUI_T(kc)    MT(MOD_LGUI, kc)
+#define RCTL_T(kc)    MT(MOD_RCTL, kc)
+#define RGUI_T(kc)    MT(MOD_RGUI, kc)
+#define MEH_T(kc)     MT(MOD_MEH, kc)
+#define LT(layer, kc) (QK_LAYER_TAP | (((layer) & 0xF) << 8) | ((kc) & 0xFF))
+#define TO(layer)     (QK_TO | ((layer) & 0x1F))
+#define OSM(mod)      (QK_ONE_SHOT_MOD | ((mod) & 0x1F))
+
+#define KC_TILD LSFT(KC_GRV)
+#define KC_EXLM LSFT(KC_1)
+#define KC_AT   LSFT(KC_2)
+#define KC_HASH LSFT(KC_3)
+#define KC_DLR  LSFT(KC_4)
+#define KC_PERC LSFT(KC_5)
+#define KC_CIRC LSFT(KC_6)
+#define KC_AMPR LSFT(KC_7)
+#define KC_ASTR LSFT(KC_8)
+#define KC_LPRN LSFT(KC_9)
+#define KC_RPRN LSFT(KC_0)
+#define KC_UNDS LSFT(KC_MINS)
+#define KC_PLUS LSFT(KC_EQL)
+#define KC_PIPE LSFT(KC_BSLS)
+#define KC_COLN LSFT(KC_SCLN)
+#define KC_LT   LSFT(KC_COMM)
+#define KC_QUES LSFT(KC_SLSH)
+#define KC_LCBR LSFT(KC_LBRC)
+#define KC_RCBR LSFT(KC_RBRC)
+#define KC_DQUO LSFT(KC_QUOT)
+#define KC_GT   LSFT(KC_DOT)
+
+#define QK_BOOT QK_BOOTLOADER
+#define QK_RBT  QK_REBOOT
+#define EE_CLR  QK_CLEAR_EEPROM
+#define UG_TOGG QK_UNDERGLOW_TOGGLE
+
+//////////////////////////////// EVENTS ///////////////////////////////////////
+typedef struct
+{
+    uint8_t col;
+    uint8_t row;
+} keypos_t;
+
+typedef enum
+{
+    TICK_EVENT  = 0,
+    KEY_EVENT   = 1,
+    COMBO_EVENT = 4,
+} keyevent_type_t;
+
+typedef struct
+{
+    keypos_t key;
+    uint16_t time;
+    keyevent_type_t type;
+    bool pressed;
+} keyevent_t;
+
+typedef struct
+{
+    bool interrupted : 1;
+    uint8_t count : 4;
+} tap_t;
+
+typedef struct
+{
+    keyevent_t event;
+    tap_t tap;
+    uint16_t keycode;
+} keyrecord_t;
+
+#define KEYLOC_COMBO    254
+#define KEYEQ(a, b)     ((a).row == (b).row && (a).col == (b).col)
+#define IS_KEYEVENT(e)  ((e).type == KEY_EVENT)
+#define MAKE_COMBOEVENT(press) ((keyevent_t){.key = {KEYLOC_COMBO, KEYLOC_COMBO}, .time = timer_read() | 1, .type = COMBO_EVENT, .pressed = (press)})
+
+// Defined by each test, QMK's entry point that runs the handlers of an event.
+void process_record(keyrecord_t* record);
+
+//////////////////////////////// TIMER ////////////////////////////////////////
+extern uint32_t stub_now;
+
+#define TIMER_DIFF_16(a, b)              ((uint16_t)((a) - (b)))
+#define timer_expired(current, future)   ((uint16_t)((current) - (future)) < UINT16_MAX / 2)
+static inline uint16_t timer_read(void) { return (uint16_t)stub_now; }
+static inline uint32_t timer_read32(void) { return stub_now; }
+static inline uint16_t timer_elapsed(uint16_t last) { return TIMER_DIFF_16(timer_read(), last); }
+static inline uint32_t timer_elapsed32(uint32_t last) { return stub_now - last; }
+static inline uint16_t sync_timer_read(void) { return timer_read(); }
+void wait_ms(uint32_t ms);
+
+//////////////////////////////// DEFERRED EXEC ////////////////////////////////
+typedef uint8_t deferred_token;
+#define INVALID_DEFERRED_TOKEN 0
+typedef uint32_t (*deferred_exec_callback)(uint32_t trigger_time, void* cb_arg);
+
+deferred_token defer_exec(uint32_t delay_ms, deferred_exec_callback callback, void* cb_arg);
+bool extend_deferred_exec(deferred_token token, uint32_t delay_ms);
+bool cancel_deferred_exec(deferred_token token);
+
+//////////////////////////////// MODS AND REPORTS /////////////////////////////
+#include "host.h"
+
+uint8_t get_mods(void);
+void set_mods(uint8_t mods);
+void add_mods(uint8_t mods);
+void del_mods(uint8_t mods);
+void clear_mods(void);
+void register_mods(uint8_t mods);
+void unregister_mods(uint8_t mods);
+uint8_t get_weak_mods(void);
+void add_weak_mods(uint8_t mods);
+void del_weak_mods(uint8_t mods);
+uint8_t get_oneshot_mods(void);
+void add_oneshot_mods(uint8_t mods);
+void del_oneshot_mods(uint8_t mods);
+void clear_oneshot_mods(void);
+static inline uint8_t mod_config(uint8_t mod) { return mod; }
+
+void register_code(uint8_t code);
+void unregister_code(uint8_t code);
+void tap_code(uint8_t code);
+void register_code16(uint16_t code);
+void unregister_code16(uint16_t code);
+void tap_code16(uint16_t code);
+void send_keyboard_report(void);
+void send_string(const char* string);
+#define send_string_P send_string
+
+//////////////////////////////// LAYERS ///////////////////////////////////////
+typedef uint32_t layer_state_t;
+extern layer_state_t layer_state;
+extern layer_state_t default_layer_state;
+
+void layer_on(uint8_t layer);
+void layer_off(uint8_t layer);
+void layer_move(uint8_t layer);
+bool layer_state_is(uint8_t layer);
+uint8_t get_highest_layer(layer_state_t state);
+uint8_t keymap_layer_count(void);
+uint16_t keycode_at_keymap_location(uint8_t layer_num, uint8_t row, uint8_t column);
+#define IS_LAYER_ON(layer) layer_state_is(layer)
+void layer_state_set(layer_state_t state);
+
+//////////////////////////////// USER CALLBACKS ///////////////////////////////
+// Weak no-ops in stub.c, like QMK's, a keymap overrides them.
+layer_state_t layer_state_set_user(layer_state_t state);
+void oneshot_mods_changed_user(uint8_t mods);
+
+// Called by the keyboard core in stub/action.c.
+bool pre_process_record_user(uint16_t keycode, keyrecord_t* record);
+bool process_record_user(uint16_t keycode, keyrecord_t* record);
+void matrix_scan_user(void);
+void housekeeping_task_user(void);
+void keyboard_pre_init_user(void);
+void keyboard_post_init_user(void);
+uint16_t get_tapping_term(uint16_t keycode, keyrecord_t* record);
+
+//////////////////////////////// COMBOS ///////////////////////////////////////
+#ifndef COMBO_TERM
+#define COMBO_TERM 50
+#endif
+#define COMBO_END 0
+
+typedef struct
+{
+    const uint16_t* keys;
+    uint16_t keycode;
+} combo_t;
+
+#define COMBO(ck, ca) {.keys = &(ck)[0], .keycode = (ca)}
+
+uint16_t get_combo_term(uint16_t combo_index, combo_t* combo);
+bool combo_should_trigger(uint16_t combo_index, combo_t* combo, uint16_t keycode, keyrecord_t* record);
+uint16_t combo_count(void);
+combo_t* combo_get(uint16_t combo_idx);
+
+//////////////////////////////// KEY OVERRIDES ////////////////////////////////
+typedef struct
+{
+    uint16_t trigger;
+    uint8_t trigger_mods;
+    layer_state_t layers;
+    uint8_t suppressed_mods;
+    uint16_t replacement;
+} key_override_t;
+
+#define ko_make_with_layers(trigger_mods_, trigger_key, replacement_key, layer_mask)                          \
+    ((const key_override_t){.trigger = (trigger_key), .trigger_mods = (trigger_mods_), .layers = (layer_mask), \
+                            .suppressed_mods = (trigger_mods_), .replacement = (replacement_key)})
+#define ko_make_basic(trigger_mods_, trigger_key, replacement_key) \
+    ko_make_with_layers(trigger_mods_, trigger_key, replacement_key, ~0)
+
+uint16_t key_override_count(void);
+const key_override_t* key_override_get(uint16_t key_override_idx);
+
+//////////////////////////////// MOUSE KEYS ///////////////////////////////////
+report_mouse_t mousekey_get_report(void);
+
+//////////////////////////////// RGB LIGHT ////////////////////////////////////
+#define HSV_BLACK  0, 0, 0
+#define RGB_BLACK  0x00, 0x00, 0x00
+#define RGB_BLUE   0x00, 0x00, 0xFF
+#define RGB_GREEN  0x00, 0xFF, 0x00
+#define RGB_ORANGE 0xFF, 0x80, 0x00
+#define RGB_PINK   0xFF, 0x80, 0xBF
+#define RGB_PURPLE 0x7A, 0x00, 0xFF
+#define RGB_RED    0xFF, 0x00, 0x00
+#define RGB_TEAL   0x00, 0x80, 0x80
+#define RGB_WHITE  0xFF, 0xFF, 0xFF
+#define RGB_YELLOW 0xFF, 0xFF, 0x00
+
+#define RGBLIGHT_MODE_STATIC_LIGHT 1
+
+void rgblight_enable_noeeprom(void);
+void rgblight_sethsv_noeeprom(uint8_t hue, uint8_t sat, uint8_t val);
+void rgblight_mode_noeeprom(uint8_t mode);
+
+//////////////////////////////// QUANTUM KEYS /////////////////////////////////
+// What QK_BOOT, QK_RBT, EE_CLR and UG_TOGG do, defined by the tests that
+// press them.
+void rgblight_toggle(void);
+void reset_keyboard(void);
+void soft_reset_keyboard(void);
+void eeconfig_init(void);
+
+//////////////////////////////// FLASH, EEPROM, GPIO ///////////////////////////
+static inline uint8_t pgm_read_byte(const void* p) { return *(const uint8_t*)p; }
+static inline uint16_t pgm_read_word(const void* p)
+{
+    uint16_t word;
+    memcpy(&word, p, sizeof(word));
+    return word;
+}
+#define memcpy_P memcpy
+
+bool eeconfig_is_user_datablock_valid(void);
+void eeconfig_read_user_datablock(void* data, uint8_t offset, uint8_t size);
+void eeconfig_update_user_datablock(const void* data, uint8_t offset, uint8_t size);
+
+void setPinOutput(uint8_t pin);
+void writePin(uint8_t pin, bool level);
+void rgblight_setrgb_at(uint8_t r, uint8_t g, uint8_t b, uint8_t index);
+
+typedef uint8_t matrix_row_t;
+// Defined by the tests that read the matrix.
+matrix_row_t matrix_get_row(uint8_t row);
+
+bool is_keyboard_master(void);
+bool is_keyboard_left(void);
+uint32_t last_input_activity_elapsed(void);
+
+//////////////////////////////// TEST SUPPORT /////////////////////////////////
+#include "stub.h"
@@ -0,0 +1,3 @@
+#pragma once
+
+// send_string() of the stub types US ASCII, which is all the keymap sends.
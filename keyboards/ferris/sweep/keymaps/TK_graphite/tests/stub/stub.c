@@ -0,0 +1,497 @@
+#include "quantum.h"
+
+uint32_t stub_now;
+uint32_t stub_waited_ms;
+bool stub_master = true;
+uint32_t stub_idle_ms;
+layer_state_t layer_state;
+layer_state_t default_layer_state = 1;
+void (*stub_on_tick)(void);
+
+stub_report_t stub_reports[STUB_REPORT_MAX];
+uint16_t stub_report_count;
+int stub_checks;
+int stub_failures;
+
+bool stub_pin_level[256];
+bool stub_pin_output[256];
+uint8_t stub_rgb[MATRIX_ROWS][3];
+uint16_t stub_rgb_writes;
+
+static uint8_t real_mods;
+static uint8_t weak_mods;
+static uint8_t oneshot_mods;
+static uint8_t keys[STUB_REPORT_KEYS];
+// Last report built by send_keyboard_report(), and last one the host got.
+static report_keyboard_t last_report;
+static report_keyboard_t host_report;
+static char typed[4096];
+static size_t typed_length;
+static uint8_t eeprom[256];
+
+//////////////////////////////// TYPED TEXT ///////////////////////////////////
+static const char unshifted[] =
+    "\0\0\0\0abcdefghijklmnopqrstuvwxyz1234567890\n\0\b\t -=[]\\\0;'`,./";
+static const char shifted[] =
+    "\0\0\0\0ABCDEFGHIJKLMNOPQRSTUVWXYZ!@#$%^&*()\n\0\b\t _+{}|\0:\"~<>?";
+
+static void append(const char* text)
+{
+    const size_t length = strlen(text);
+    if(typed_length + length < sizeof(typed))
+    {
+        memcpy(typed + typed_length, text, length + 1);
+        typed_length += length;
+    }
+}
+
+static void append_key(uint8_t key, uint8_t mods)
+{
+    if(mods & MOD_MASK_CTRL)
+        append("C-");
+    if(mods & MOD_MASK_ALT)
+        append("A-");
+    if(mods & MOD_MASK_GUI)
+        append("G-");
+    const bool shift = mods & MOD_MASK_SHIFT;
+    char text[8];
+    if(key == KC_ESC)
+        strcpy(text, "[ESC]");
+    else if(key == KC_BSPC)
+        strcpy(text, "\b");
+    else if(key < sizeof(unshifted) - 1 && unshifted[key])
+    {
+        text[0] = shift ? shifted[key] : unshifted[key];
+        text[1] = '\0';
+    }
+    else
+        snprintf(text, sizeof(text), "%s[%02X]", shift ? "S-" : "", key);
+    append(text);
+}
+
+const char* stub_typed(void)
+{
+    return typed;
+}
+
+void stub_clear_typed(void)
+{
+    typed[0]     = '\0';
+    typed_length = 0;
+}
+
+//////////////////////////////// REPORTS //////////////////////////////////////
+static void host_send_keyboard(report_keyboard_t* report)
+{
+    for(uint8_t i = 0; i < STUB_REPORT_KEYS; i++)
+    {
+        if(report->keys[i] && !memchr(host_report.keys, report->keys[i], STUB_REPORT_KEYS))
+            append_key(report->keys[i], report->mods);
+    }
+    host_report = *report;
+    if(stub_report_count < STUB_REPORT_MAX)
+        stub_reports[stub_report_count++] = *report;
+}
+
+static host_driver_t stub_driver = {.send_keyboard = host_send_keyboard};
+static host_driver_t* driver     = &stub_driver;
+
+void host_set_driver(host_driver_t* new_driver) { driver = new_driver; }
+host_driver_t* host_get_driver(void) { return driver; }
+
+void host_mouse_send(report_mouse_t* report)
+{
+    if(driver->send_mouse)
+        driver->send_mouse(report);
+}
+
+void host_consumer_send(uint16_t usage)
+{
+    report_extra_t report = {REPORT_ID_CONSUMER, usage};
+    if(driver->send_extra)
+        driver->send_extra(&report);
+}
+
+// Like QMK, only sends a report that changed. One-shot mods go out with the
+// first report that has a key.
+void send_keyboard_report(void)
+{
+    report_keyboard_t report = {.mods = real_mods | weak_mods | oneshot_mods};
+    memcpy(report.keys, keys, sizeof(keys));
+    if(oneshot_mods)
+    {
+        for(uint8_t i = 0; i < STUB_REPORT_KEYS; i++)
+        {
+            if(keys[i])
+            {
+                clear_oneshot_mods();
+                break;
+            }
+        }
+    }
+    if(memcmp(&report, &last_report, sizeof(report)) == 0)
+        return;
+    last_report = report;
+    driver->send_keyboard(&report);
+}
+
+uint8_t stub_report_mods(void)
+{
+    return host_report.mods;
+}
+
+uint8_t get_mods(void) { return real_mods; }
+void set_mods(uint8_t mods) { real_mods = mods; }
+void add_mods(uint8_t mods) { real_mods |= mods; }
+void del_mods(uint8_t mods) { real_mods &= ~mods; }
+void clear_mods(void) { real_mods = 0; }
+uint8_t get_weak_mods(void) { return weak_mods; }
+void add_weak_mods(uint8_t mods) { weak_mods |= mods; }
+void del_weak_mods(uint8_t mods) { weak_mods &= ~mods; }
+uint8_t get_oneshot_mods(void) { return oneshot_mods; }
+
+static void set_oneshot_mods(uint8_t mods)
+{
+    if(mods != oneshot_mods)
+    {
+        oneshot_mods = mods;
+        oneshot_mods_changed_user(mods);
+    }
+}
+
+void add_oneshot_mods(uint8_t mods) { set_oneshot_mods(oneshot_mods | mods); }
+void del_oneshot_mods(uint8_t mods) { set_oneshot_mods(oneshot_mods & ~mods); }
+void clear_oneshot_mods(void) { set_oneshot_mods(0); }
+
+__attribute__((weak)) void oneshot_mods_changed_user(uint8_t mods) {}
+
+void register_mods(uint8_t mods)
+{
+    real_mods |= mods;
+    send_keyboard_report();
+}
+
+void unregister_mods(uint8_t mods)
+{
+    real_mods &= ~mods;
+    send_keyboard_report();
+}
+
+// QMK stores five-bit mods in keycodes, bit 4 selecting the right-hand ones.
+static uint8_t mods_from_keycode(uint8_t mods)
+{
+    return (mods & 0x10) ? (uint8_t)((mods & 0x0F) << 4) : mods;
+}
+
+void register_code(uint8_t code)
+{
+    if(IS_MODIFIER_KEYCODE(code))
+    {
+        register_mods(MOD_BIT(code));
+        return;
+    }
+    for(uint8_t i = 0; i < STUB_REPORT_KEYS; i++)
+    {
+        if(keys[i] == code)
+            return;
+    }
+    for(uint8_t i = 0; i < STUB_REPORT_KEYS; i++)
+    {
+        if(!keys[i])
+        {
+            keys[i] = code;
+            break;
+        }
+    }
+    send_keyboard_report();
+}
+
+void unregister_code(uint8_t code)
+{
+    if(IS_MODIFIER_KEYCODE(code))
+    {
+        unregister_mods(MOD_BIT(code));
+        return;
+    }
+    for(uint8_t i = 0; i < STUB_REPORT_KEYS; i++)
+    {
+        if(keys[i] == code)
+            keys[i] = 0;
+    }
+    send_keyboard_report();
+}
+
+void tap_code(uint8_t code)
+{
+    register_code(code);
+    wait_ms(TAP_CODE_DELAY);
+    unregister_code(code);
+}
+
+void register_code16(uint16_t code)
+{
+    const uint8_t mods = IS_QK_MODS(code) ? mods_from_keycode(QK_MODS_GET_MODS(code)) : 0;
+    if(mods)
+    {
+        weak_mods |= mods;
+        send_keyboard_report();
+    }
+    register_code(code & 0xFF);
+}
+
+void unregister_code16(uint16_t code)
+{
+    unregister_code(code & 0xFF);
+    if(IS_QK_MODS(code))
+    {
+        weak_mods &= ~mods_from_keycode(QK_MODS_GET_MODS(code));
+        send_keyboard_report();
+    }
+}
+
+void tap_code16(uint16_t code)
+{
+    register_code16(code);
+    wait_ms(TAP_CODE_DELAY);
+    unregister_code16(code);
+}
+
+void send_string(const char* string)
+{
+    for(; *string; string++)
+    {
+        for(uint8_t key = 0; key < sizeof(unshifted) - 1; key++)
+        {
+            if(unshifted[key] == *string)
+            {
+                tap_code(key);
+                break;
+            }
+            if(shifted[key] == *string)
+            {
+                tap_code16(LSFT(key));
+                break;
+            }
+        }
+    }
+}
+
+void stub_default_action(uint16_t keycode, const keyrecord_t* record)
+{
+    if(IS_QK_MOD_TAP(keycode))
+        keycode = QK_MOD_TAP_GET_TAP_KEYCODE(keycode);
+    else if(IS_QK_LAYER_TAP(keycode))
+        keycode = QK_LAYER_TAP_GET_TAP_KEYCODE(keycode);
+    else if(IS_QK_ONE_SHOT_MOD(keycode))
+    {
+        if(record->event.pressed)
+            add_oneshot_mods(mods_from_keycode(keycode & 0x1F));
+        return;
+    }
+    if(keycode > QK_MODS_MAX || keycode == KC_NO)
+        return;
+    if(record->event.pressed)
+        register_code16(keycode);
+    else
+        unregister_code16(keycode);
+}
+
+keyrecord_t stub_key(uint8_t row, uint8_t col, bool pressed)
+{
+    return (keyrecord_t){
+        .event = {.key = {.col = col, .row = row}, .time = timer_read() | 1, .type = KEY_EVENT, .pressed = pressed},
+    };
+}
+
+//////////////////////////////// TIME /////////////////////////////////////////
+typedef struct
+{
+    deferred_token token;
+    uint32_t trigger_time;
+    deferred_exec_callback callback;
+    void* cb_arg;
+} executor_t;
+
+static executor_t executors[MAX_DEFERRED_EXECUTORS];
+static deferred_token last_token;
+
+deferred_token defer_exec(uint32_t delay_ms, deferred_exec_callback callback, void* cb_arg)
+{
+    if(!delay_ms)
+        return INVALID_DEFERRED_TOKEN;
+    for(uint8_t i = 0; i < MAX_DEFERRED_EXECUTORS; i++)
+    {
+        if(executors[i].token == INVALID_DEFERRED_TOKEN)
+        {
+            if(++last_token == INVALID_DEFERRED_TOKEN)
+                ++last_token;
+            executors[i] = (executor_t){last_token, stub_now + delay_ms, callback, cb_arg};
+            return last_token;
+        }
+    }
+    return INVALID_DEFERRED_TOKEN;
+}
+
+static executor_t* find_executor(deferred_token token)
+{
+    for(uint8_t i = 0; token && i < MAX_DEFERRED_EXECUTORS; i++)
+    {
+        if(executors[i].token == token)
+            return &executors[i];
+    }
+    return NULL;
+}
+
+bool extend_deferred_exec(deferred_token token, uint32_t delay_ms)
+{
+    executor_t* executor = find_executor(token);
+    if(!executor || !delay_ms)
+        return false;
+    executor->trigger_time = stub_now + delay_ms;
+    return true;
+}
+
+bool cancel_deferred_exec(deferred_token token)
+{
+    executor_t* executor = find_executor(token);
+    if(!executor)
+        return false;
+    executor->token = INVALID_DEFERRED_TOKEN;
+    return true;
+}
+
+uint8_t stub_deferred_in_use(void)
+{
+    uint8_t count = 0;
+    for(uint8_t i = 0; i < MAX_DEFERRED_EXECUTORS; i++)
+        count += executors[i].token != INVALID_DEFERRED_TOKEN;
+    return count;
+}
+
+static void run_executors(void)
+{
+    for(uint8_t i = 0; i < MAX_DEFERRED_EXECUTORS; i++)
+    {
+        executor_t* executor = &executors[i];
+        if(executor->token == INVALID_DEFERRED_TOKEN || executor->trigger_time > stub_now)
+            continue;
+        const deferred_token token = executor->token;
+        const uint32_t delay       = executor->callback(executor->trigger_time, executor->cb_arg);
+        // The callback may have cancelled itself or been replaced.
+        if(executor->token != token)
+            continue;
+        if(delay)
+            executor->trigger_time += delay;
+        else
+            executor->token = INVALID_DEFERRED_TOKEN;
+    }
+}
+
+void stub_advance(uint32_t ms)
+{
+    while(ms--)
+    {
+        stub_now++;
+        run_executors();
+        if(stub_on_tick)
+            stub_on_tick();
+    }
+}
+
+void wait_ms(uint32_t ms)
+{
+    stub_now += ms;
+    stub_waited_ms += ms;
+}
+
+uint32_t last_input_activity_elapsed(void)
+{
+    return stub_idle_ms;
+}
+
+//////////////////////////////// LAYERS ///////////////////////////////////////
+__attribute__((weak)) layer_state_t layer_state_set_user(layer_state_t state)
+{
+    return state;
+}
+
+void layer_state_set(layer_state_t state)
+{
+    layer_state = layer_state_set_user(state);
+}
+
+void layer_on(uint8_t layer) { layer_state_set(layer_state | (layer_state_t)1 << layer); }
+void layer_off(uint8_t layer) { layer_state_set(layer_state & ~((layer_state_t)1 << layer)); }
+void layer_move(uint8_t layer) { layer_state_set((layer_state_t)1 << layer); }
+
+// Like QMK, with no layer on only layer 0 is.
+bool layer_state_is(uint8_t layer)
+{
+    return layer_state ? (layer_state >> layer) & 1 : layer == 0;
+}
+
+uint8_t get_highest_layer(layer_state_t state)
+{
+    uint8_t layer = 0;
+    while(state >>= 1)
+        layer++;
+    return layer;
+}
+
+//////////////////////////////// HARDWARE /////////////////////////////////////
+bool eeconfig_is_user_datablock_valid(void) { return true; }
+
+void eeconfig_read_user_datablock(void* data, uint8_t offset, uint8_t size)
+{
+    memcpy(data, eeprom + offset, size);
+}
+
+void eeconfig_update_user_datablock(const void* data, uint8_t offset, uint8_t size)
+{
+    memcpy(eeprom + offset, data, size);
+}
+
+void setPinOutput(uint8_t pin) { stub_pin_output[pin] = true; }
+void writePin(uint8_t pin, bool level) { stub_pin_level[pin] = level; }
+
+void rgblight_enable_noeeprom(void) {}
+void rgblight_sethsv_noeeprom(uint8_t hue, uint8_t sat, uint8_t val) {}
+void rgblight_mode_noeeprom(uint8_t mode) {}
+
+void rgblight_setrgb_at(uint8_t r, uint8_t g, uint8_t b, uint8_t index)
+{
+    stub_rgb[index][0] = r;
+    stub_rgb[index][1] = g;
+    stub_rgb[index][2] = b;
+    stub_rgb_writes++;
+}
+
+bool is_keyboard_master(void) { return stub_master; }
+bool is_keyboard_left(void) { return true; }
+
+//////////////////////////////// TEST SUPPORT /////////////////////////////////
+void stub_reset(void)
+{
+    stub_now = 1000;
+    stub_waited_ms = 0;
+    stub_idle_ms = 0;
+    stub_master = true;
+    stub_on_tick = NULL;
+    real_mods = weak_mods = oneshot_mods = 0;
+    memset(keys, 0, sizeof(keys));
+    memset(&last_report, 0, sizeof(last_report));
+    memset(&host_report, 0, sizeof(host_report));
+    driver = &stub_driver;
+    memset(executors, 0, sizeof(executors));
+    stub_report_count = 0;
+    layer_state = 0;
+    default_layer_state = 1;
+    stub_rgb_writes = 0;
+    stub_clear_typed();
+}
+
+int stub_finish(const char* name)
+{
+    printf("%s: %d checks, %d failed\n", name, stub_checks, stub_failures);
+    return stub_failures ? 1 : 0;
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+// Test-side view of the QMK stub: the fake clock, the report log, and the
+// checks used by the tests.
+
+#define STUB_REPORT_KEYS KEYBOARD_REPORT_KEYS
+#define STUB_REPORT_MAX  1024
+
+// Reports as the host received them, after any driver installed over the
+// stub's own.
+typedef report_keyboard_t stub_report_t;
+
+extern stub_report_t stub_reports[STUB_REPORT_MAX];
+extern uint16_t stub_report_count;
+extern uint32_t stub_waited_ms;
+extern bool stub_master;
+extern uint32_t stub_idle_ms;
+extern bool stub_pin_level[256];
+extern bool stub_pin_output[256];
+extern uint8_t stub_rgb[MATRIX_ROWS][3];
+extern uint16_t stub_rgb_writes;
+
+/** Resets the clock, mods, layers, report log and deferred executors. */
+void stub_reset(void);
+
+/** Advances the clock one millisecond at a time, running due executors and
+ *  the optional per-millisecond hook. */
+void stub_advance(uint32_t ms);
+extern void (*stub_on_tick)(void);
+
+/** Number of deferred executors currently scheduled. */
+uint8_t stub_deferred_in_use(void);
+
+/** Returns what the host would have typed since the last stub_reset() or
+ *  stub_clear_typed(): every key that went down, Shift applied on a US
+ *  layout, other mods as "C-", "A-", "G-" prefixes and unnamed keys as
+ *  "[XX]". The buffer is owned by the stub. */
+const char* stub_typed(void);
+void stub_clear_typed(void);
+
+/** The mods of the last report the host received. */
+uint8_t stub_report_mods(void);
+
+/** Default action for a keycode the modules let through: basic keycodes and
+ *  modded keycodes press and release like QMK's action layer. */
+void stub_default_action(uint16_t keycode, const keyrecord_t* record);
+
+/** Builds a key event at the current time. */
+keyrecord_t stub_key(uint8_t row, uint8_t col, bool pressed);
+
+//////////////////////////////// KEYBOARD CORE ////////////////////////////////
+// QMK's core in stub/action.c, for tests that build the whole keymap. They
+// define the keymap introspection functions and the quantum keys.
+
+/** Sets a key of the matrix, the next stub_keyboard_task() sends its event. */
+void stub_matrix_set(uint8_t row, uint8_t col, bool pressed);
+
+/** Clears the matrix and runs the keymap's init callbacks. */
+void stub_keyboard_init(void);
+
+/** One pass of QMK's keyboard_task(): matrix_scan_user(), an event per
+ *  matrix change, the tap-hold and combo timers, housekeeping_task_user(). */
+void stub_keyboard_task(void);
+
+// What the keys reached, as bits: the layers keys were pressed on, the combos
+// whose keys all came down within their term, the key overrides that fired,
+// and the custom keycodes pressed, counted from SAFE_RANGE.
+extern uint32_t stub_layers_pressed;
+extern uint32_t stub_combos_completed;
+extern uint32_t stub_overrides_fired;
+extern uint64_t stub_custom_keycodes;
+
+//////////////////////////////// CHECKS ///////////////////////////////////////
+extern int stub_checks;
+extern int stub_failures;
+
+#define CHECK(cond)                                                            \
+    do                                                                         \
+    {                                                                          \
+        stub_checks++;                                                         \
+        if(!(cond))                                                            \
+        {                                                                      \
+            stub_failures++;                                                   \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__,   \
+                    #cond);                                                    \
+        }                                                                      \
+    } while(0)
+
+#define CHECK_INT(actual, expected)                                            \
+    do                                                                         \
+    {                                                                          \
+        const long long actual_   = (long long)(actual);                       \
+        const long long expected_ = (long long)(expected);                     \
+        stub_checks++;                                                         \
+        if(actual_ != expected_)                                               \
+        {                                                                      \
+            stub_failures++;                                                   \
+            fprintf(stderr, "%s:%d: %s is %lld, expected %lld\n", __FILE__,    \
+                    __LINE__, #actual, actual_, expected_);                    \
+        }                                                                      \
+    } while(0)
+
+#define CHECK_STR(actual, expected)                                            \
+    do                                                                         \
+    {                                                                          \
+        const char* actual_   = (actual);                                      \
+        const char* expected_ = (expected);                                    \
+        stub_checks++;                                                         \
+        if(strcmp(actual_, expected_) != 0)                                    \
+        {                                                                      \
+            stub_failures++;                                                   \
+            fprintf(stderr, "%s:%d: %s is \"%s\", expected \"%s\"\n",          \
+                    __FILE__, __LINE__, #actual, actual_, expected_);          \
+        }                                                                      \
+    } while(0)
+
+/** Prints a summary and returns the exit status for main(). */
+int stub_finish(const char* name);
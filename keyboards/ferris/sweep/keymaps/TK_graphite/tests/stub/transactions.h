@@ -0,0 +1,12 @@
+#pragma once
+
+// Split transport RPCs. The tests define the transfer itself.
+
+#include "quantum.h"
+
+#define RPC_S2M_BUFFER_SIZE 32
+
+typedef void (*slave_callback_t)(uint8_t initiator2target_buffer_size, const void* initiator2target_buffer, uint8_t target2initiator_buffer_size, void* target2initiator_buffer);
+
+void transaction_register_rpc(int8_t transaction_id, slave_callback_t callback);
+bool transaction_rpc_recv(int8_t transaction_id, uint8_t target2initiator_buffer_size, void* target2initiator_buffer);
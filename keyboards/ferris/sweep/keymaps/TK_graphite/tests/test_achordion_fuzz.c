@@ -0,0 +1,471 @@
+#include "quantum.h"
+#include "keycodes.h"
+#include "features/achordion.h"
+#include "features/typing_speed.h"
+
+#include <stdarg.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Property-based fuzzer for Achordion, built with ACHORDION_STREAK and
+// ACHORDION_RELEASE_ORDER like the keymap and with the keymap's callbacks
+// from tap_hold.c. Random streams of presses, releases, combo events, scan
+// gaps and restamped event times run through the typing speed estimator the
+// callbacks read, Achordion and a model of QMK's action layer, checking after
+// every event:
+//
+//  * No nested plumbing: process_record() is never entered more than once
+//    from inside Achordion's own re-dispatch.
+//  * Every physical press reaches the action layer exactly once, and is
+//    released there before or with its physical release.
+//  * No stuck mods: only the mods of mod-taps physically down are held.
+//  * Eager Alt and GUI are never rolled back alone, that opens a menu. A
+//    lone release is only fine for a mod-tap held on its own.
+//
+// A failing stream is shrunk by deleting events and shortening gaps while it
+// still fails, then printed. Directed checks at the end pin down the
+// behaviour behind these properties on known streams.
+//
+//   ./test_achordion_fuzz [streams [seed]]   defaults: 20000 streams, seed 1
+
+//////////////////////////////// LAYOUT ///////////////////////////////////////
+// The keymap's home row on both halves, a few plain keys around it, the
+// thumb keys and a combo sending Enter. Rows 0 to 3 are the left half, 4 to 7
+// the right.
+static const uint16_t keymap[MATRIX_ROWS][MATRIX_COLS] = {
+    [0] = {KC_Q, KC_L, KC_D, KC_W, KC_Z},
+    [1] = {MEH_T(KC_N), LGUI_T(KC_R), LALT_T(KC_T), LCTL_T(KC_S), LT(NUM_LAYER, KC_G)},
+    [3] = {OSM(MOD_LSFT), KC_BSPC},
+    [4] = {KC_SCLN, KC_F, KC_O, KC_U, KC_J},
+    [5] = {KC_Y, RCTL_T(KC_H), LALT_T(KC_A), RGUI_T(KC_E), MEH_T(KC_I)},
+    [7] = {NAV_HOLD, SYM_WIN_LAYER},
+};
+
+static const keypos_t fuzzed_keys[] = {
+    {0, 1}, {1, 1}, {2, 1}, {3, 1}, {4, 1}, {1, 0}, {2, 0}, {0, 3}, {1, 3},
+    {0, 5}, {1, 5}, {2, 5}, {3, 5}, {4, 5}, {1, 4}, {2, 4}, {0, 7}, {1, 7},
+};
+#define KEYS  ARRAY_SIZE(fuzzed_keys)
+#define COMBO_STEP KEYS
+
+//////////////////////////////// STREAMS //////////////////////////////////////
+typedef struct
+{
+    uint16_t gap;  // Milliseconds scanned before the event.
+    uint8_t key;  // Index into fuzzed_keys, or COMBO_STEP.
+    uint8_t late;  // Milliseconds the event is stamped before it's seen.
+    bool pressed;
+    bool tapped;  // QMK's tap-hold decision for a tap-hold press.
+} step_t;
+
+typedef struct
+{
+    uint16_t pace;  // Longest gap while typing.
+    uint16_t length;
+    step_t steps[64];
+} stream_t;
+
+static uint32_t rng_state;
+
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+// Random walk over the keys: press one that's up or release one that's down,
+// mostly at the pace of the stream, sometimes past the timeouts. The pace
+// spans typing fast enough for the callbacks to turn eager mods off and
+// stretch the streak, and slow enough for neither.
+static void generate(stream_t* stream)
+{
+    bool down[KEYS + 1] = {0};
+
+    stream->pace   = 60 + rng() % 340;
+    stream->length = 8 + rng() % (ARRAY_SIZE(stream->steps) - 8);
+    for(uint16_t i = 0; i < stream->length; i++)
+    {
+        step_t* step  = &stream->steps[i];
+        step->key     = rng() % 16 == 0 ? COMBO_STEP : rng() % KEYS;
+        step->pressed = !down[step->key];
+        step->tapped  = rng() % 2;
+        step->gap     = rng() % 6 == 0 ? rng() % 1000 : rng() % stream->pace;
+        step->late    = rng() % 8 == 0 ? rng() % 20 : 0;
+        down[step->key] = step->pressed;
+    }
+}
+
+static void print_stream(const stream_t* stream)
+{
+    fprintf(stderr, "  pace %u ms\n", stream->pace);
+    for(uint16_t i = 0; i < stream->length; i++)
+    {
+        const step_t* step = &stream->steps[i];
+        fprintf(stderr, "  +%4u ms ", step->gap);
+        if(step->key == COMBO_STEP)
+            fprintf(stderr, "combo");
+        else
+            fprintf(stderr, "0x%04X", keymap[fuzzed_keys[step->key].row][fuzzed_keys[step->key].col]);
+        fprintf(stderr, " %s%s", step->pressed ? "down" : "up", step->pressed && step->tapped ? " (tapped)" : "");
+        if(MIN(step->late, step->gap))
+            fprintf(stderr, ", stamped %u ms early", MIN(step->late, step->gap));
+        fprintf(stderr, "\n");
+    }
+}
+
+//////////////////////////////// ACTION LAYER /////////////////////////////////
+// What the action layer registered for each key, released with it.
+typedef struct
+{
+    bool active;
+    uint8_t mods;
+    uint8_t code;
+    uint8_t layer;
+    uint8_t presses;  // Since the physical press.
+} action_t;
+
+static action_t actions[KEYS + 1];
+static bool down[KEYS + 1];
+static uint8_t tap_counts[KEYS + 1];
+static uint8_t depth;
+static bool held_alone;
+static char failure[256];
+
+static void fail(const char* format, ...)
+{
+    if(failure[0])
+        return;
+    va_list args;
+    va_start(args, format);
+    vsnprintf(failure, sizeof(failure), format, args);
+    va_end(args);
+}
+
+static uint8_t key_index(keypos_t pos)
+{
+    if(pos.row == KEYLOC_COMBO)
+        return COMBO_STEP;
+    for(uint8_t i = 0; i < KEYS; i++)
+    {
+        if(KEYEQ(fuzzed_keys[i], pos))
+            return i;
+    }
+    return COMBO_STEP;
+}
+
+static uint8_t mods_from_keycode(uint8_t mods)
+{
+    return (mods & 0x10) ? (uint8_t)((mods & 0x0F) << 4) : mods;
+}
+
+static void action(uint16_t keycode, const keyrecord_t* record)
+{
+    action_t* action = &actions[key_index(record->event.key)];
+    if(!record->event.pressed)
+    {
+        if(!action->active)
+        {
+            fail("0x%04X released without a press", keycode);
+            return;
+        }
+        if(action->mods & (MOD_MASK_ALT | MOD_MASK_GUI))
+            held_alone = true;
+        unregister_mods(action->mods);
+        if(action->code)
+            unregister_code(action->code);
+        if(action->layer)
+            layer_off(action->layer);
+        action->active = false;
+        return;
+    }
+
+    if(action->active)
+        fail("0x%04X pressed twice", keycode);
+    *action = (action_t){.active = true, .presses = action->presses + 1};
+    const bool held = record->tap.count == 0;
+    if(IS_QK_MOD_TAP(keycode) && held)
+        action->mods = mods_from_keycode(QK_MOD_TAP_GET_MODS(keycode));
+    else if(IS_QK_LAYER_TAP(keycode) && held)
+        action->layer = QK_LAYER_TAP_GET_LAYER(keycode);
+    else if(IS_QK_MOD_TAP(keycode) || IS_QK_LAYER_TAP(keycode) || keycode <= QK_BASIC_MAX)
+        action->code = keycode & 0xFF;
+    // The thumb layers and one-shot Shift only matter to Achordion here.
+    register_mods(action->mods);
+    if(action->code)
+        register_code(action->code);
+    if(action->layer)
+        layer_on(action->layer);
+}
+
+void process_record(keyrecord_t* record)
+{
+    if(++depth > 2)
+        fail("nested plumbing");
+    const uint16_t keycode = record->event.type == COMBO_EVENT ? record->keycode : keymap[record->event.key.row][record->event.key.col];
+    if(process_achordion(keycode, record))
+        action(keycode, record);
+    --depth;
+}
+
+//////////////////////////////// PROPERTIES ///////////////////////////////////
+static uint16_t reports_seen;
+static bool menu_armed;
+
+// Eager Alt or GUI going away with no key pressed under it.
+static void check_reports(void)
+{
+    for(; reports_seen < stub_report_count; reports_seen++)
+    {
+        const uint8_t menu_mods = stub_reports[reports_seen].mods & (MOD_MASK_ALT | MOD_MASK_GUI);
+        const uint8_t before    = reports_seen ? stub_reports[reports_seen - 1].mods & (MOD_MASK_ALT | MOD_MASK_GUI) : 0;
+        bool keys               = false;
+        for(uint8_t i = 0; i < STUB_REPORT_KEYS; i++)
+            keys |= stub_reports[reports_seen].keys[i] != 0;
+
+        if(menu_mods && keys)
+            menu_armed = false;
+        else if(menu_mods && !before)
+            menu_armed = true;
+        else if(!menu_mods && before && menu_armed)
+        {
+            if(!held_alone)
+                fail("Alt/GUI rolled back alone");
+            menu_armed = false;
+        }
+    }
+    held_alone = false;
+}
+
+static void check_state(void)
+{
+    uint8_t held_mods = 0;
+    for(uint8_t i = 0; i < KEYS; i++)
+    {
+        const uint16_t keycode = keymap[fuzzed_keys[i].row][fuzzed_keys[i].col];
+        if(down[i] && IS_QK_MOD_TAP(keycode))
+            held_mods |= mods_from_keycode(QK_MOD_TAP_GET_MODS(keycode));
+    }
+    if(get_mods() & ~held_mods)
+        fail("stuck mods 0x%02X", get_mods() & ~held_mods);
+
+    for(uint8_t i = 0; i <= KEYS; i++)
+    {
+        if(actions[i].active && !down[i])
+            fail("key %u still pressed after its release", i);
+    }
+    check_reports();
+}
+
+//////////////////////////////// RUNNER ///////////////////////////////////////
+static uint32_t events;
+
+// Resets the stub but keeps the clock running, so the typing speed sees the
+// pause since the last run and starts a new burst.
+static void restart(void)
+{
+    const uint32_t now = stub_now;
+    stub_reset();
+    stub_now     = now;
+    stub_on_tick = achordion_task;
+}
+
+static void event(uint8_t key, bool pressed, bool tapped, uint8_t late)
+{
+    keyrecord_t record;
+    if(key == COMBO_STEP)
+    {
+        record            = (keyrecord_t){.event = MAKE_COMBOEVENT(pressed), .keycode = KC_ENT};
+        record.event.time = (uint16_t)(timer_read() - late) | 1;
+    }
+    else
+    {
+        const keypos_t pos     = fuzzed_keys[key];
+        const uint16_t keycode = keymap[pos.row][pos.col];
+        record = (keyrecord_t){
+            .event = {.key = pos, .time = (uint16_t)(timer_read() - late) | 1, .type = KEY_EVENT, .pressed = pressed},
+        };
+        if(pressed)
+            tap_counts[key] = (IS_QK_MOD_TAP(keycode) || IS_QK_LAYER_TAP(keycode)) && tapped;
+        record.tap.count = tap_counts[key];
+    }
+
+    if(pressed)
+        actions[key].presses = 0;
+    down[key] = pressed;
+    pre_process_typing_speed(record.keycode, &record);
+    process_record(&record);
+    ++events;
+
+    if(!pressed && actions[key].presses != 1)
+        fail("key %u reached the action layer %u times", key, actions[key].presses);
+}
+
+// Runs a stream, then releases every key and waits out the timeouts, even
+// after a failure, so the next run starts from the same idle Achordion. Steps
+// left invalid by shrinking, a press of a key down or a release of one up,
+// are skipped. Returns the first broken property, or NULL.
+static const char* run(const stream_t* stream)
+{
+    restart();
+    memset(actions, 0, sizeof(actions));
+    memset(down, 0, sizeof(down));
+    depth          = 0;
+    held_alone     = false;
+    menu_armed     = false;
+    reports_seen   = 0;
+    failure[0]     = '\0';
+
+    for(uint16_t i = 0; i < stream->length; i++)
+    {
+        const step_t* step = &stream->steps[i];
+        stub_advance(step->gap);
+        check_state();
+        if(step->pressed != down[step->key])
+        {
+            event(step->key, step->pressed, step->tapped, MIN(step->late, step->gap));
+            check_state();
+        }
+    }
+    for(uint8_t key = 0; key <= KEYS; key++)
+    {
+        if(down[key])
+        {
+            stub_advance(10);
+            event(key, false, false, 0);
+            check_state();
+        }
+    }
+    stub_advance(2000);
+    check_state();
+    if(!failure[0] && (get_mods() || stub_report_mods()))
+        fail("mods 0x%02X left after every key is released", get_mods() | stub_report_mods());
+    return failure[0] ? failure : NULL;
+}
+
+// Deletes runs of steps, halving the run length down to one step, and then
+// shortens the gaps and drops the restamps, keeping every change after which
+// the stream still fails.
+static void shrink(stream_t* stream)
+{
+    for(uint16_t chunk = stream->length / 2; chunk; chunk /= 2)
+    {
+        for(uint16_t start = 0; start + chunk <= stream->length;)
+        {
+            stream_t smaller = *stream;
+            memmove(&smaller.steps[start], &smaller.steps[start + chunk], (smaller.length - start - chunk) * sizeof(step_t));
+            smaller.length -= chunk;
+            if(run(&smaller))
+                *stream = smaller;
+            else
+                start++;
+        }
+    }
+    for(uint16_t i = 0; i < stream->length; i++)
+    {
+        while(stream->steps[i].gap)
+        {
+            stream_t smaller = *stream;
+            smaller.steps[i].gap /= 2;
+            if(!run(&smaller))
+                break;
+            *stream = smaller;
+        }
+        stream_t on_time = *stream;
+        on_time.steps[i].late = 0;
+        if(run(&on_time))
+            *stream = on_time;
+    }
+}
+
+static void fuzz(uint32_t streams, uint32_t seed)
+{
+    rng_state = seed ? seed : 1;
+    const clock_t start = clock();
+    for(uint32_t i = 0; i < streams; i++)
+    {
+        stream_t stream;
+        generate(&stream);
+        const char* broken = run(&stream);
+        stub_checks++;
+        if(broken)
+        {
+            stub_failures++;
+            fprintf(stderr, "stream %u of seed %u: %s\n", i, seed, broken);
+            shrink(&stream);
+            fprintf(stderr, "shrunk to %u events: %s\n", stream.length, run(&stream));
+            print_stream(&stream);
+            return;
+        }
+    }
+    const double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    printf("achordion_fuzz: %u streams, %u events in %.1f s\n", streams, events, seconds);
+}
+
+//////////////////////////////// DIRECTED CHECKS //////////////////////////////
+static void start(void)
+{
+    stub_advance(2000);  // Past the timeouts and streak of the last check.
+    restart();
+    memset(actions, 0, sizeof(actions));
+    memset(down, 0, sizeof(down));
+}
+
+// Index of the key at a position in fuzzed_keys.
+static uint8_t at(uint8_t row, uint8_t col)
+{
+    return key_index((keypos_t){.col = col, .row = row});
+}
+
+int main(int argc, char** argv)
+{
+    const uint8_t ctl_s = at(1, 3), gui_r = at(1, 1), y = at(5, 0), d = at(0, 2), f = at(4, 1);
+
+    // Release order: the other key released first settles a hold.
+    start();
+    event(ctl_s, true, false, 0);
+    stub_advance(50);
+    event(y, true, false, 0);
+    stub_advance(50);
+    event(y, false, false, 0);
+    event(ctl_s, false, false, 0);
+    CHECK_STR(stub_typed(), "C-y");
+
+    // The tap-hold key released first right after is a roll.
+    start();
+    event(ctl_s, true, false, 0);
+    stub_advance(50);
+    event(y, true, false, 0);
+    stub_advance(30);
+    event(ctl_s, false, false, 0);
+    event(y, false, false, 0);
+    CHECK_STR(stub_typed(), "sy");
+
+    // Eager GUI on a same-hand tap is masked before it's rolled back.
+    start();
+    event(gui_r, true, false, 0);
+    CHECK_INT(stub_report_mods(), MOD_BIT(KC_LGUI));
+    stub_advance(50);
+    event(d, true, false, 0);
+    event(d, false, false, 0);
+    event(gui_r, false, false, 0);
+    CHECK_STR(stub_typed(), "G-[73]rd");
+    CHECK_INT(stub_report_mods(), 0);
+
+    // A streak is judged by the time a key was pressed, not when it's seen:
+    // the mod-tap and the key after it, stamped 90 and 95 ms after the plain
+    // key, are in its streak even though it has expired when they're seen.
+    start();
+    event(f, true, false, 0);
+    event(f, false, false, 0);
+    stub_advance(110);
+    event(ctl_s, true, false, 20);
+    event(y, true, false, 15);
+    event(y, false, false, 0);
+    event(ctl_s, false, false, 0);
+    CHECK_STR(stub_typed(), "fsy");
+
+    fuzz(argc > 1 ? strtoul(argv[1], NULL, 0) : 20000, argc > 2 ? strtoul(argv[2], NULL, 0) : 1);
+    return stub_finish("achordion_fuzz");
+}
@@ -0,0 +1,187 @@
+#include "quantum.h"
+#include "keycodes.h"
+#include "features/achordion.h"
+#include "features/typing_speed.h"
+
+#include <time.h>
+
+// Latency and cost of Achordion's chord and streak decisions, built like the
+// keymap with ACHORDION_STREAK, ACHORDION_RELEASE_ORDER and the callbacks
+// from tap_hold.c. Scripts of timed key events are played one millisecond,
+// one scan, at a time, and the time the host sees the outcome is measured
+// from the key that decided it. Events of the same millisecond are processed
+// back to back, as QMK dispatches all the changes of a scan.
+
+static const uint16_t keymap[MATRIX_ROWS][MATRIX_COLS] = {
+    [0] = {KC_Q, KC_L, KC_D, KC_W, KC_Z},
+    [1] = {MEH_T(KC_N), LGUI_T(KC_R), LALT_T(KC_T), LCTL_T(KC_S), LT(NUM_LAYER, KC_G)},
+    [5] = {KC_Y, RCTL_T(KC_H), LALT_T(KC_A), RGUI_T(KC_E), MEH_T(KC_I)},
+};
+
+// QMK's action layer: held mod-taps register their mods.
+void process_record(keyrecord_t* record)
+{
+    const uint16_t keycode = keymap[record->event.key.row][record->event.key.col];
+    if(!process_achordion(keycode, record))
+    {
+        return;
+    }
+    if(IS_QK_MOD_TAP(keycode) && record->tap.count == 0)
+    {
+        const uint8_t mods = QK_MOD_TAP_GET_MODS(keycode);
+        const uint8_t bits = (mods & 0x10) ? (mods & 0x0F) << 4 : mods;
+        if(record->event.pressed)
+        {
+            register_mods(bits);
+        }
+        else
+        {
+            unregister_mods(bits);
+        }
+        return;
+    }
+    stub_default_action(keycode, record);
+}
+
+static uint8_t tap_counts[MATRIX_ROWS][MATRIX_COLS];
+
+static void event(uint8_t row, uint8_t col, bool pressed, bool tapped)
+{
+    keyrecord_t record = stub_key(row, col, pressed);
+    if(pressed)
+    {
+        tap_counts[row][col] = tapped;
+    }
+    record.tap.count = tap_counts[row][col];
+    pre_process_typing_speed(keymap[row][col], &record);
+    process_record(&record);
+}
+
+typedef struct
+{
+    uint16_t at;
+    uint8_t row;
+    uint8_t col;
+    bool pressed;
+    bool tapped;  // QMK's tap-hold decision for a tap-hold press.
+} step_t;
+
+typedef struct
+{
+    int16_t mods_at;  // First millisecond the host has a mod down, or -1.
+    int16_t typed_at;  // Millisecond the host typed its last key.
+    char typed[32];
+} outcome_t;
+
+// Plays `steps` after a pause long enough to end any streak and burst.
+static outcome_t play(const step_t* steps, uint8_t count)
+{
+    stub_advance(2000);
+    const uint32_t now = stub_now;
+    stub_reset();
+    stub_now     = now;
+    stub_on_tick = achordion_task;
+
+    outcome_t outcome = {.mods_at = -1, .typed_at = -1};
+    uint8_t next      = 0;
+    size_t typed      = 0;
+    for(int16_t ms = 0; ms < 2000; ms++)
+    {
+        for(; next < count && steps[next].at == ms; next++)
+        {
+            event(steps[next].row, steps[next].col, steps[next].pressed, steps[next].tapped);
+        }
+        if(outcome.mods_at < 0 && stub_report_mods())
+        {
+            outcome.mods_at = ms;
+        }
+        if(strlen(stub_typed()) != typed)
+        {
+            typed            = strlen(stub_typed());
+            outcome.typed_at = ms;
+        }
+        stub_advance(1);
+    }
+    snprintf(outcome.typed, sizeof(outcome.typed), "%s", stub_typed());
+    return outcome;
+}
+
+// Ctrl on S, and Y of the other hand.
+#define CTL_S_DOWN(at, tapped) {at, 1, 3, true, tapped}
+#define CTL_S_UP(at)           {at, 1, 3, false, false}
+#define Y_DOWN(at)             {at, 5, 0, true, false}
+#define Y_UP(at)               {at, 5, 0, false, false}
+#define Q_TAP(at)              {at, 0, 0, true, false}, {at + 20, 0, 0, false, false}
+
+// Presses of a long roll over both hands, for the cost per event.
+static uint32_t cost(uint32_t count)
+{
+    static const keypos_t keys[] = {{0, 0}, {1, 0}, {1, 1}, {3, 1}, {2, 1}, {0, 5}, {1, 5}, {3, 5}, {4, 0}, {2, 5}};
+    uint32_t rng   = 1;
+    uint32_t taken = 0;
+    stub_advance(2000);
+    for(uint32_t i = 0; i < count; i++)
+    {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        const keypos_t key = keys[rng % ARRAY_SIZE(keys)];
+        stub_advance(30 + rng % 60);
+        const clock_t start = clock();
+        event(key.row, key.col, true, rng & 0x100);
+        event(key.row, key.col, false, false);
+        taken += clock() - start;
+        stub_clear_typed();
+    }
+    stub_advance(2000);
+    return (uint32_t)((double)taken * 1e9 / CLOCKS_PER_SEC / (2 * count));
+}
+
+int main(void)
+{
+    // Chord, nobody typing: eager Ctrl reaches the host with the press. Y
+    // goes out with it once Y is released first, its hold time after.
+    const step_t chord[] = {CTL_S_DOWN(0, false), Y_DOWN(50), Y_UP(120), CTL_S_UP(200)};
+    outcome_t outcome    = play(chord, ARRAY_SIZE(chord));
+    CHECK_STR(outcome.typed, "C-y");
+    CHECK_INT(outcome.mods_at, 0);
+    CHECK_INT(outcome.typed_at - 50, 70);
+
+    // Both keys of the chord in one scan, or Y a scan later: the same
+    // outcome, a scan apart, nothing waits for a batch.
+    const step_t same_scan[]  = {CTL_S_DOWN(0, false), Y_DOWN(0), Y_UP(70), CTL_S_UP(150)};
+    const step_t next_scan[]  = {CTL_S_DOWN(0, false), Y_DOWN(1), Y_UP(71), CTL_S_UP(150)};
+    const outcome_t same      = play(same_scan, ARRAY_SIZE(same_scan));
+    const outcome_t next_only = play(next_scan, ARRAY_SIZE(next_scan));
+    CHECK_STR(same.typed, "C-y");
+    CHECK_STR(next_only.typed, same.typed);
+    CHECK_INT(next_only.typed_at - same.typed_at, 1);
+
+    // Typing fast, eager mods are off: Ctrl waits for the decision too.
+    const step_t fast[] = {
+        Q_TAP(0), Q_TAP(80), Q_TAP(160), Q_TAP(240), Q_TAP(320), Q_TAP(400),
+        CTL_S_DOWN(600, false), Y_DOWN(650), Y_UP(720), CTL_S_UP(800),
+    };
+    outcome = play(fast, ARRAY_SIZE(fast));
+    CHECK_STR(outcome.typed, "qqqqqqC-y");
+    CHECK_INT(outcome.mods_at, 720);
+
+    // S rolled into Y, QMK's permissive hold calls S held. In a streak
+    // Achordion settles it as a tap at once, out of one the tap waits for S
+    // to be released before Y.
+    const step_t streak[] = {Q_TAP(0), CTL_S_DOWN(50, false), Y_DOWN(60), CTL_S_UP(80), Y_UP(110)};
+    const outcome_t in    = play(streak, ARRAY_SIZE(streak));
+    CHECK_STR(in.typed, "qsy");
+    CHECK_INT(in.typed_at - 60, 0);
+    CHECK_INT(in.mods_at, -1);
+    const step_t no_streak[] = {Q_TAP(0), CTL_S_DOWN(300, false), Y_DOWN(310), CTL_S_UP(330), Y_UP(360)};
+    const outcome_t out      = play(no_streak, ARRAY_SIZE(no_streak));
+    CHECK_STR(out.typed, "qsy");
+    CHECK_INT(out.typed_at - 310, 20);
+
+    const uint32_t ns = cost(100000);
+    CHECK(ns < 10000);
+    printf("achordion_latency: chord %d ms after the other key (its hold), roll %d ms in a streak, %d ms out of one, %u ns per event\n",
+           same.typed_at, in.typed_at - 60, out.typed_at - 310, ns);
+    return stub_finish("achordion_latency");
+}
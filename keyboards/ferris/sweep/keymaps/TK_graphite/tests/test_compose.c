@@ -0,0 +1,118 @@
+#include "quantum.h"
+#include "features/compose.h"
+
+#define ACCENT_LAYER 1
+
+enum
+{
+    ACC_E = SAFE_RANGE,
+};
+
+const compose_t compose_table[] = {
+    {KC_QUOT, KC_E, {RALT(KC_E)}},
+};
+const uint8_t compose_table_count = ARRAY_SIZE(compose_table);
+
+void process_record(keyrecord_t* record) {}
+
+bool compose_layer_user(void)
+{
+    return layer_state_is(ACCENT_LAYER);
+}
+
+uint16_t compose_base_user(uint16_t keycode)
+{
+    return keycode == ACC_E ? KC_E : KC_NO;
+}
+
+static void key(uint16_t keycode, bool pressed)
+{
+    keyrecord_t record = stub_key(0, 0, pressed);
+    if(process_compose(keycode, &record))
+    {
+        stub_default_action(keycode, &record);
+    }
+    stub_advance(10);
+}
+
+static void tap(uint16_t keycode)
+{
+    key(keycode, true);
+    key(keycode, false);
+}
+
+int main(void)
+{
+    // A literal dead key owes a space only before a combining letter.
+    stub_reset();
+    tap(KC_QUOT);
+    tap(KC_1);
+    CHECK_STR(stub_typed(), "'1");
+    stub_reset();
+    tap(KC_QUOT);
+    tap(KC_E);
+    CHECK_STR(stub_typed(), "' e");
+
+    // The timeout completes it with held mods lifted, e.g. an eager Ctrl
+    // registered by Achordion.
+    stub_reset();
+    tap(KC_QUOT);
+    register_mods(MOD_BIT(KC_LCTL));
+    stub_advance(COMPOSE_DEAD_KEY_TIMEOUT);
+    CHECK_STR(stub_typed(), "' ");
+    CHECK_INT(stub_report_mods(), MOD_BIT(KC_LCTL));
+    CHECK_INT(stub_deferred_in_use(), 0);
+
+    // So does a one-shot Ctrl followed by a combining letter.
+    stub_reset();
+    tap(KC_QUOT);
+    add_oneshot_mods(MOD_BIT(KC_LCTL));
+    tap(KC_E);
+    CHECK_STR(stub_typed(), "' C-e");
+
+    // Pressing Ctrl completes it before the mod is registered.
+    stub_reset();
+    tap(KC_QUOT);
+    key(KC_LCTL, true);
+    CHECK_STR(stub_typed(), "' ");
+    tap(KC_C);
+    key(KC_LCTL, false);
+    CHECK_STR(stub_typed(), "' C-c");
+    CHECK_INT(stub_deferred_in_use(), 0);
+
+    // Shift doesn't, it only changes the letter.
+    stub_reset();
+    tap(KC_QUOT);
+    key(KC_LSFT, true);
+    CHECK_STR(stub_typed(), "'");
+    tap(KC_1);
+    key(KC_LSFT, false);
+    CHECK_STR(stub_typed(), "'!");
+    stub_advance(COMPOSE_DEAD_KEY_TIMEOUT);
+
+    // On the accent layer the dead key waits for the accent key.
+    stub_reset();
+    layer_on(ACCENT_LAYER);
+    tap(KC_QUOT);
+    CHECK_STR(stub_typed(), "");
+    tap(ACC_E);
+    CHECK_STR(stub_typed(), "A-e");
+
+    // It is dropped when the layer is left...
+    stub_reset();
+    layer_on(ACCENT_LAYER);
+    tap(KC_QUOT);
+    layer_off(ACCENT_LAYER);
+    tap(KC_E);
+    CHECK_STR(stub_typed(), "e");
+
+    // ...or after the timeout.
+    stub_reset();
+    layer_on(ACCENT_LAYER);
+    tap(KC_QUOT);
+    stub_advance(COMPOSE_PENDING_TIMEOUT);
+    tap(ACC_E);
+    CHECK_STR(stub_typed(), "e");
+
+    return stub_finish("compose");
+}
@@ -0,0 +1,622 @@
+#include "keymap.c"
+#include "transactions.h"
+
+#include <stdarg.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Golden traces of the whole keymap: keymap.c, its config.h and every
+// feature in rules.mk, built on the core model of stub/action.c. A script of
+// key presses in golden/*.keys is played one millisecond, one scan, at a
+// time, and what the host gets, keyboard, mouse and consumer reports, is
+// traced with the layer and one-shot mod changes. The trace must match the
+// golden/*.trace next to the script. Each script runs in a process of its
+// own, from the keymap's power-on state.
+//
+// Together the scripts must press a key on every layer, complete every combo,
+// fire every key override and press every custom keycode on the keymap,
+// which is checked at the end. Combos and overrides the keymap gives no way
+// to press are listed instead.
+//
+//   ./test_golden golden/*.keys             compare with the golden traces
+//   ./test_golden --update golden/*.keys    write the golden traces
+//
+// A script has one command per line, keys named by their legend on the alpha
+// layer, # starts a comment:
+//
+//   down KEY...      press the keys in one scan
+//   up KEY...        release the keys in one scan
+//   tap KEY...       down, TAP_MS later up, TAP_MS later the next command
+//   wait MS          scan for MS milliseconds
+//   layer NAME       move to a layer directly, as TO() would
+//
+// Every trace line starts with the milliseconds since the script started.
+// The last trace of a script is in build/, diff it with the golden one.
+
+#define TAP_MS    50
+#define SETTLE_MS 2000
+
+//////////////////////////////// INTROSPECTION ////////////////////////////////
+// Like QMK's keymap_introspection.c, which includes the keymap too.
+uint8_t keymap_layer_count(void)
+{
+    return ARRAY_SIZE(keymaps);
+}
+
+uint16_t keycode_at_keymap_location(uint8_t layer_num, uint8_t row, uint8_t column)
+{
+    return keymaps[layer_num][row][column];
+}
+
+uint16_t combo_count(void)
+{
+    return ARRAY_SIZE(key_combos);
+}
+
+combo_t* combo_get(uint16_t combo_idx)
+{
+    return &key_combos[combo_idx];
+}
+
+uint16_t key_override_count(void)
+{
+    return ARRAY_SIZE(key_overrides);
+}
+
+const key_override_t* key_override_get(uint16_t key_override_idx)
+{
+    return key_overrides[key_override_idx];
+}
+
+#define COMB(name, action, ...) #name,
+static const char* const combo_names[] = {
+#include "combos.def"
+};
+#undef COMB
+
+static const char* const layer_names[] = {
+    [ALPHA_LAYER] = "alpha",   [SYM_LAYER] = "sym",       [NUM_LAYER] = "num",         [NAV_LAYER] = "nav",
+    [WIN_NAV_LAYER] = "win_nav", [FN_LAYER] = "fn",       [MEDIA_LAYER] = "media",     [GAMING_LAYER] = "gaming",
+    [ACCENT_LAYER] = "accent", [QMK_LAYER] = "qmk",
+};
+_Static_assert(ARRAY_SIZE(layer_names) == ARRAY_SIZE(keymaps), "Name every layer");
+
+// clang-format off
+static const char* const key_names[MATRIX_ROWS][MATRIX_COLS] = {
+    {"q", "l", "d", "w", "z"}, {"n", "r", "t", "s", "g"}, {"b", "x", "m", "c", "v"}, {"shift", "bspc"},
+    {"scln", "f", "o", "u", "j"}, {"y", "h", "a", "e", "i"}, {"k", "p", "dot", "comm", "mins"}, {"nav", "sym"},
+};
+// clang-format on
+
+//////////////////////////////// TRACE ////////////////////////////////////////
+static char* trace        = NULL;
+static size_t trace_size  = 0;
+static FILE* trace_file   = NULL;
+static uint32_t start     = 0;
+
+static void trace_line(const char* format, ...)
+{
+    fprintf(trace_file, "%6u ", stub_now - start);
+    va_list args;
+    va_start(args, format);
+    vfprintf(trace_file, format, args);
+    va_end(args);
+    fputc('\n', trace_file);
+}
+
+static void print_mods(char* text, size_t size, uint8_t mods)
+{
+    static const char* const names[] = {"LCtl", "LSft", "LAlt", "LGui", "RCtl", "RSft", "RAlt", "RGui"};
+    text[0] = '\0';
+    for(uint8_t bit = 0; bit < 8; bit++)
+    {
+        if(mods & (1 << bit))
+        {
+            snprintf(text + strlen(text), size - strlen(text), "%s%s", text[0] ? "+" : "", names[bit]);
+        }
+    }
+    if(!text[0])
+    {
+        snprintf(text, size, "-");
+    }
+}
+
+static void print_key(char* text, size_t size, uint8_t key)
+{
+    static const char punctuation[] = "-=[]\\#;'`,./";
+    if(key >= KC_A && key <= KC_Z)
+        snprintf(text, size, "%c", 'a' + key - KC_A);
+    else if(key >= KC_1 && key <= KC_0)
+        snprintf(text, size, "%c", key == KC_0 ? '0' : '1' + key - KC_1);
+    else if(key >= KC_MINS && key <= KC_SLSH)
+        snprintf(text, size, "%c", punctuation[key - KC_MINS]);
+    else if(key >= KC_F1 && key <= KC_F12)
+        snprintf(text, size, "F%d", 1 + key - KC_F1);
+    else if(key >= KC_KP_1 && key <= KC_KP_0)
+        snprintf(text, size, "KP%c", key == KC_KP_0 ? '0' : '1' + key - KC_KP_1);
+    else
+    {
+        static const struct
+        {
+            uint8_t key;
+            const char* name;
+        } names[] = {
+            {KC_ENT, "Ent"},      {KC_ESC, "Esc"},       {KC_BSPC, "Bspc"},     {KC_TAB, "Tab"},
+            {KC_SPC, "Spc"},      {KC_PGDN, "PgDn"},     {KC_RGHT, "Right"},    {KC_LEFT, "Left"},
+            {KC_DOWN, "Down"},    {KC_UP, "Up"},         {KC_PSLS, "KP/"},      {KC_PAST, "KP*"},
+            {KC_PMNS, "KP-"},     {KC_PPLS, "KP+"},
+        };
+        snprintf(text, size, "[%02X]", key);
+        for(uint8_t i = 0; i < ARRAY_SIZE(names); i++)
+        {
+            if(names[i].key == key)
+            {
+                snprintf(text, size, "%s", names[i].name);
+            }
+        }
+    }
+}
+
+static void trace_keyboard(report_keyboard_t* report)
+{
+    char text[128];
+    print_mods(text, sizeof(text), report->mods);
+    for(uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++)
+    {
+        if(report->keys[i])
+        {
+            strcat(text, " ");
+            print_key(text + strlen(text), sizeof(text) - strlen(text), report->keys[i]);
+        }
+    }
+    trace_line("kbd %s", text);
+}
+
+static void trace_mouse(report_mouse_t* report)
+{
+    trace_line("mouse buttons %02X x %d y %d v %d h %d", report->buttons, report->x, report->y, report->v, report->h);
+}
+
+static void trace_extra(report_extra_t* report)
+{
+    trace_line("consumer %04X", report->usage);
+}
+
+static host_driver_t trace_driver = {
+    .send_keyboard = trace_keyboard,
+    .send_mouse    = trace_mouse,
+    .send_extra    = trace_extra,
+};
+
+void reset_keyboard(void)
+{
+    trace_line("bootloader");
+}
+
+void soft_reset_keyboard(void)
+{
+    trace_line("reboot");
+}
+
+void eeconfig_init(void)
+{
+    trace_line("eeprom cleared");
+}
+
+void rgblight_toggle(void)
+{
+    trace_line("rgb toggled");
+}
+
+// Both halves are in the matrix here, the slave sends no timestamps.
+void transaction_register_rpc(int8_t transaction_id, slave_callback_t callback) {}
+
+bool transaction_rpc_recv(int8_t transaction_id, uint8_t target2initiator_buffer_size, void* target2initiator_buffer)
+{
+    return false;
+}
+
+static uint8_t traced_layer;
+static uint8_t traced_oneshot;
+
+static void trace_state(void)
+{
+    const uint8_t layer = get_highest_layer(layer_state | default_layer_state);
+    if(layer != traced_layer)
+    {
+        traced_layer = layer;
+        trace_line("layer %s", layer_names[layer]);
+    }
+    if(get_oneshot_mods() != traced_oneshot)
+    {
+        char text[64];
+        traced_oneshot = get_oneshot_mods();
+        print_mods(text, sizeof(text), traced_oneshot);
+        trace_line("oneshot %s", text);
+    }
+}
+
+//////////////////////////////// SCRIPTS //////////////////////////////////////
+static const char* script_path;
+static int script_line;
+
+static void script_error(const char* message, const char* word)
+{
+    fprintf(stderr, "%s:%d: %s \"%s\"\n", script_path, script_line, message, word);
+    exit(2);
+}
+
+static void scan(uint32_t ms)
+{
+    while(ms--)
+    {
+        stub_advance(1);
+        stub_keyboard_task();
+        trace_state();
+    }
+}
+
+static void set_keys(char* keys, bool pressed)
+{
+    char names[256] = "";
+    for(char* name = strtok(keys, " \t"); name; name = strtok(NULL, " \t"))
+    {
+        bool found = false;
+        for(uint8_t row = 0; row < MATRIX_ROWS && !found; row++)
+        {
+            for(uint8_t col = 0; col < MATRIX_COLS && !found; col++)
+            {
+                if(key_names[row][col] && strcmp(key_names[row][col], name) == 0)
+                {
+                    stub_matrix_set(row, col, pressed);
+                    found = true;
+                }
+            }
+        }
+        if(!found)
+        {
+            script_error("unknown key", name);
+        }
+        snprintf(names + strlen(names), sizeof(names) - strlen(names), " %s", name);
+    }
+    // The scan that sees the keys.
+    stub_advance(1);
+    trace_line("%s%s", pressed ? "down" : "up", names);
+    stub_keyboard_task();
+    trace_state();
+}
+
+static void run_command(char* line)
+{
+    char* comment = strchr(line, '#');
+    if(comment)
+    {
+        *comment = '\0';
+    }
+    line[strcspn(line, "\r\n")] = '\0';
+    char* command = strtok(line, " \t");
+    char* rest    = strtok(NULL, "");
+    if(!command)
+    {
+        return;
+    }
+    if(!rest)
+    {
+        rest = "";
+    }
+
+    if(strcmp(command, "down") == 0 || strcmp(command, "up") == 0)
+    {
+        set_keys(rest, command[0] == 'd');
+    }
+    else if(strcmp(command, "tap") == 0)
+    {
+        char keys[256];
+        snprintf(keys, sizeof(keys), "%s", rest);
+        set_keys(keys, true);
+        scan(TAP_MS - 1);
+        set_keys(rest, false);
+        scan(TAP_MS - 1);
+    }
+    else if(strcmp(command, "wait") == 0)
+    {
+        scan(strtoul(rest, NULL, 10));
+    }
+    else if(strcmp(command, "layer") == 0)
+    {
+        const char* name = strtok(rest, " \t");
+        for(uint8_t layer = 0; name && layer < ARRAY_SIZE(layer_names); layer++)
+        {
+            if(strcmp(layer_names[layer], name) == 0)
+            {
+                layer_move(layer);
+                trace_state();
+                return;
+            }
+        }
+        script_error("unknown layer", name ? name : "");
+    }
+    else
+    {
+        script_error("unknown command", command);
+    }
+}
+
+// Replaces the extension of `path`, keeping the directory unless `directory`.
+static void replace_extension(char* out, size_t size, const char* path, const char* directory, const char* extension)
+{
+    const char* name = directory ? strrchr(path, '/') : NULL;
+    name             = name ? name + 1 : path;
+    snprintf(out, size, "%s%s%s", directory ? directory : "", directory ? "/" : "", name);
+    char* dot = strrchr(out, '.');
+    if(dot)
+    {
+        *dot = '\0';
+    }
+    snprintf(out + strlen(out), size - strlen(out), "%s", extension);
+}
+
+static char* read_file(const char* path)
+{
+    FILE* file = fopen(path, "rb");
+    if(!file)
+    {
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    const long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char* text = calloc(1, size + 1);
+    if(fread(text, 1, size, file) != (size_t)size)
+    {
+        text[0] = '\0';
+    }
+    fclose(file);
+    return text;
+}
+
+static bool write_file(const char* path, const char* text)
+{
+    FILE* file = fopen(path, "wb");
+    if(!file)
+    {
+        return false;
+    }
+    fputs(text, file);
+    return fclose(file) == 0;
+}
+
+// Prints the first line where the traces differ.
+static void report_difference(const char* golden_path, const char* golden, const char* actual)
+{
+    int line = 1;
+    while(*golden && *golden == *actual)
+    {
+        line += *golden == '\n';
+        golden++;
+        actual++;
+    }
+    while(line > 1 && golden[-1] != '\n')
+    {
+        golden--;
+        actual--;
+    }
+    fprintf(stderr, "%s:%d: expected \"%.*s\"\n", golden_path, line, (int)strcspn(golden, "\n"), golden);
+    fprintf(stderr, "%s:%d:      got \"%.*s\"\n", golden_path, line, (int)strcspn(actual, "\n"), actual);
+}
+
+typedef struct
+{
+    uint32_t layers;
+    uint32_t combos;
+    uint32_t overrides;
+    uint64_t custom_keycodes;
+} coverage_t;
+
+// Plays a script, returns the exit status of its process.
+static int run(const char* path, bool update, coverage_t* coverage)
+{
+    FILE* script = fopen(path, "r");
+    if(!script)
+    {
+        fprintf(stderr, "%s: can't open\n", path);
+        return 2;
+    }
+    trace_file = open_memstream(&trace, &trace_size);
+    stub_reset();
+    host_set_driver(&trace_driver);
+    stub_keyboard_init();
+    start = stub_now;
+
+    script_path = path;
+    char line[256];
+    for(script_line = 1; fgets(line, sizeof(line), script); script_line++)
+    {
+        run_command(line);
+    }
+    fclose(script);
+    scan(SETTLE_MS);
+    fclose(trace_file);
+
+    coverage->layers |= stub_layers_pressed;
+    coverage->combos |= stub_combos_completed;
+    coverage->overrides |= stub_overrides_fired;
+    coverage->custom_keycodes |= stub_custom_keycodes;
+
+    char golden_path[256];
+    char actual_path[256];
+    replace_extension(golden_path, sizeof(golden_path), path, NULL, ".trace");
+    replace_extension(actual_path, sizeof(actual_path), path, "build", ".trace");
+    write_file(actual_path, trace);
+    if(update)
+    {
+        return write_file(golden_path, trace) ? 0 : 1;
+    }
+    char* golden = read_file(golden_path);
+    if(!golden)
+    {
+        fprintf(stderr, "%s: missing, run make update-golden\n", golden_path);
+        return 1;
+    }
+    if(strcmp(golden, trace) != 0)
+    {
+        report_difference(golden_path, golden, trace);
+        return 1;
+    }
+    return 0;
+}
+
+//////////////////////////////// COVERAGE /////////////////////////////////////
+static bool on_layer(uint8_t layer, uint16_t keycode)
+{
+    for(uint8_t row = 0; row < MATRIX_ROWS; row++)
+    {
+        for(uint8_t col = 0; col < MATRIX_COLS; col++)
+        {
+            if(keycode_at_keymap_location(layer, row, col) == keycode)
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// A combo is reachable when all its keys are on one layer.
+static bool combo_reachable(const combo_t* combo)
+{
+    for(uint8_t layer = 0; layer < keymap_layer_count(); layer++)
+    {
+        bool all = true;
+        for(const uint16_t* key = combo->keys; *key != COMBO_END && all; key++)
+        {
+            all = on_layer(layer, *key);
+        }
+        if(all)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// A key override is reachable when its trigger is on one of its layers.
+static bool override_reachable(const key_override_t* override)
+{
+    for(uint8_t layer = 0; layer < keymap_layer_count(); layer++)
+    {
+        if(((override->layers >> layer) & 1) && on_layer(layer, override->trigger))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void mark_custom(uint64_t* keycodes, uint16_t keycode)
+{
+    if(keycode >= SAFE_RANGE && keycode < SAFE_RANGE + 64)
+    {
+        *keycodes |= (uint64_t)1 << (keycode - SAFE_RANGE);
+    }
+}
+
+static void require(bool covered, const char* format, ...)
+{
+    stub_checks++;
+    if(!covered)
+    {
+        stub_failures++;
+        fprintf(stderr, "golden: ");
+        va_list args;
+        va_start(args, format);
+        vfprintf(stderr, format, args);
+        va_end(args);
+        fputc('\n', stderr);
+    }
+}
+
+// Entries no script can reach are dead in the keymap itself, they are listed
+// rather than failed.
+static void check_coverage(const coverage_t* coverage)
+{
+    for(uint8_t layer = 0; layer < keymap_layer_count(); layer++)
+    {
+        require(coverage->layers & ((uint32_t)1 << layer), "no key pressed on layer %s", layer_names[layer]);
+    }
+    for(uint16_t i = 0; i < combo_count(); i++)
+    {
+        if(!combo_reachable(combo_get(i)))
+        {
+            printf("golden: combo %s is unreachable, its keys are on no one layer\n", combo_names[i]);
+            continue;
+        }
+        require(coverage->combos & ((uint32_t)1 << i), "combo %s not completed", combo_names[i]);
+    }
+
+    uint64_t on_keymap = 0;
+    for(uint16_t i = 0; i < key_override_count(); i++)
+    {
+        if(!override_reachable(key_override_get(i)))
+        {
+            printf("golden: key override %d is unreachable, its trigger is on none of its layers\n", i);
+            continue;
+        }
+        require(coverage->overrides & ((uint32_t)1 << i), "key override %d not fired", i);
+        mark_custom(&on_keymap, key_override_get(i)->replacement);
+    }
+    for(uint8_t layer = 0; layer < keymap_layer_count(); layer++)
+    {
+        for(uint8_t row = 0; row < MATRIX_ROWS; row++)
+        {
+            for(uint8_t col = 0; col < MATRIX_COLS; col++)
+            {
+                mark_custom(&on_keymap, keycode_at_keymap_location(layer, row, col));
+            }
+        }
+    }
+    for(uint16_t i = 0; i < combo_count(); i++)
+    {
+        mark_custom(&on_keymap, combo_get(i)->keycode);
+    }
+    for(uint8_t i = 0; i < 64; i++)
+    {
+        if(on_keymap & ((uint64_t)1 << i))
+        {
+            require(coverage->custom_keycodes & ((uint64_t)1 << i), "custom keycode SAFE_RANGE + %d not pressed", i);
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const bool update = argc > 1 && strcmp(argv[1], "--update") == 0;
+    coverage_t* coverage =
+        mmap(NULL, sizeof(coverage_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if(coverage == MAP_FAILED)
+    {
+        perror("mmap");
+        return 2;
+    }
+    memset(coverage, 0, sizeof(*coverage));
+
+    int scripts = 0;
+    for(int i = update ? 2 : 1; i < argc; i++)
+    {
+        fflush(NULL);
+        const pid_t pid = fork();
+        if(pid == 0)
+        {
+            _exit(run(argv[i], update, coverage));
+        }
+        int status = 0;
+        waitpid(pid, &status, 0);
+        CHECK(pid > 0 && WIFEXITED(status) && WEXITSTATUS(status) == 0);
+        scripts++;
+    }
+    check_coverage(coverage);
+    printf("golden: %d scripts%s\n", scripts, update ? ", traces written" : "");
+    return stub_finish("golden");
+}
@@ -0,0 +1,52 @@
+#include "quantum.h"
+#include "features/idle_scheduler.h"
+
+void process_record(keyrecord_t* record) {}
+
+static bool busy;
+
+bool idle_busy_user(void)
+{
+    return busy;
+}
+
+int main(void)
+{
+    stub_reset();
+    CHECK_INT(idle_scheduler_update(0, false), IDLE_ACTIVE);
+    CHECK_INT(idle_scheduler_update(IDLE_QUIET_TIMEOUT - 1, false), IDLE_ACTIVE);
+    CHECK_INT(idle_scheduler_update(IDLE_QUIET_TIMEOUT, false), IDLE_QUIET);
+    CHECK_INT(idle_scheduler_update(IDLE_SLOW_TIMEOUT, false), IDLE_SLOW);
+    CHECK_INT(idle_scheduler_stage(), IDLE_SLOW);
+    // Busy, e.g. a gliding mouse, stays active.
+    CHECK_INT(idle_scheduler_update(IDLE_SLOW_TIMEOUT, true), IDLE_ACTIVE);
+    CHECK_INT(idle_scheduler_update(0, false), IDLE_ACTIVE);
+
+    // Only the slow stage sleeps, a step down to IDLE_SLOW_SCAN_INTERVAL per pass.
+    stub_idle_ms = IDLE_QUIET_TIMEOUT;
+    CHECK_INT(idle_scheduler_task(), IDLE_QUIET);
+    CHECK_INT(stub_waited_ms, 0);
+    stub_idle_ms = IDLE_SLOW_TIMEOUT;
+    for(uint8_t i = 0; i < 100; ++i)
+    {
+        CHECK_INT(idle_scheduler_task(), IDLE_SLOW);
+    }
+    CHECK_INT(stub_waited_ms, 100 * IDLE_SLOW_SCAN_INTERVAL);
+
+    // The first pass after a key press is at full rate and bounds how long
+    // the press could have waited.
+    CHECK(IDLE_SLOW_SCAN_INTERVAL >= 10);
+    CHECK_INT(idle_scheduler_wake_bound(), 0);
+    stub_idle_ms = 0;
+    CHECK_INT(idle_scheduler_task(), IDLE_ACTIVE);
+    CHECK_INT(stub_waited_ms, 100 * IDLE_SLOW_SCAN_INTERVAL);
+    CHECK_INT(idle_scheduler_wake_bound(), IDLE_SLOW_SCAN_INTERVAL);
+
+    // The slave keeps its own rate.
+    stub_master  = false;
+    stub_idle_ms = IDLE_SLOW_TIMEOUT;
+    CHECK_INT(idle_scheduler_task(), IDLE_ACTIVE);
+    CHECK_INT(stub_waited_ms, 100 * IDLE_SLOW_SCAN_INTERVAL);
+
+    return stub_finish("idle_scheduler");
+}
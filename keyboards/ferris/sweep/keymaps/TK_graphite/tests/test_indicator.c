@@ -0,0 +1,60 @@
+#include "quantum.h"
+#include "features/indicator.h"
+
+void process_record(keyrecord_t* record) {}
+
+// Layers 1 and 2 share a color so a layer change need not touch the RGB.
+void indicator_rgb_user(uint16_t status, uint8_t rgb[3])
+{
+    const uint8_t layer = INDICATOR_LAYER(status);
+    rgb[0]              = layer ? 0x20 : 0;
+    rgb[1] = rgb[2] = 0;
+}
+
+int main(void)
+{
+    stub_reset();
+    indicator_init();
+    CHECK(stub_pin_output[INDICATOR_LED_PIN]);
+    // Active low, so off is high.
+    CHECK(stub_pin_level[INDICATOR_LED_PIN]);
+
+    // The first task writes the RGB even though it is black.
+    indicator_task();
+    CHECK_INT(stub_rgb_writes, 1);
+
+    indicator_set(INDICATOR_ONESHOT_SHIFT, true);
+    indicator_task();
+    CHECK(!stub_pin_level[INDICATOR_LED_PIN]);
+    CHECK_INT(stub_rgb_writes, 1);
+
+    // Caps Word on top of one-shot Shift keeps the LED lit.
+    indicator_set(INDICATOR_CAPS_WORD, true);
+    indicator_set(INDICATOR_ONESHOT_SHIFT, false);
+    indicator_task();
+    CHECK(!stub_pin_level[INDICATOR_LED_PIN]);
+    indicator_set(INDICATOR_CAPS_WORD, false);
+    indicator_task();
+    CHECK(stub_pin_level[INDICATOR_LED_PIN]);
+
+    indicator_set_layer(1);
+    indicator_task();
+    CHECK_INT(indicator_status(), 1 << INDICATOR_LAYER_SHIFT);
+    CHECK_INT(stub_rgb_writes, 2);
+    CHECK_INT(stub_rgb[INDICATOR_RGB_INDEX][0], 0x20);
+
+    indicator_set_layer(2);
+    indicator_task();
+    CHECK_INT(stub_rgb_writes, 2);
+
+    // Repeated tasks without changes write nothing.
+    indicator_task();
+    indicator_task();
+    CHECK_INT(stub_rgb_writes, 2);
+
+    indicator_set_layer(0);
+    indicator_task();
+    CHECK_INT(stub_rgb_writes, 3);
+    CHECK_INT(stub_rgb[INDICATOR_RGB_INDEX][0], 0);
+    return stub_finish("indicator");
+}
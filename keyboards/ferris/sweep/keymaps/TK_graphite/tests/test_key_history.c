@@ -0,0 +1,111 @@
+#include "quantum.h"
+#include "features/key_history.h"
+
+enum
+{
+    ARROW = SAFE_RANGE,
+};
+
+const magic_t magic_table[] = {
+    {KC_O, KC_A},
+};
+const uint8_t magic_table_count = ARRAY_SIZE(magic_table);
+
+void process_record(keyrecord_t* record) {}
+
+static void send_arrow(void)
+{
+    tap_code(KC_MINS);
+    tap_code16(KC_GT);
+    key_history_push(ARROW, 0);
+}
+
+void key_history_replay_user(uint16_t keycode)
+{
+    if(keycode == ARROW)
+    {
+        send_arrow();
+    }
+}
+
+static void key(uint16_t keycode, bool pressed, uint8_t tap_count)
+{
+    keyrecord_t record = stub_key(0, 0, pressed);
+    record.tap.count   = tap_count;
+    process_key_history(keycode, &record);
+    if(!IS_QK_MOD_TAP(keycode) || tap_count)
+    {
+        stub_default_action(keycode, &record);
+    }
+}
+
+static void tap(uint16_t keycode)
+{
+    key(keycode, true, 1);
+    key(keycode, false, 1);
+}
+
+int main(void)
+{
+    stub_reset();
+    tap(KC_A);
+    key_history_repeat();
+    CHECK_STR(stub_typed(), "aa");
+
+    // Letters repeat in the case they are typed in, other keys with their mods.
+    stub_reset();
+    key(KC_LSFT, true, 0);
+    tap(KC_B);
+    key(KC_LSFT, false, 0);
+    key_history_repeat();
+    CHECK_STR(stub_typed(), "Bb");
+    stub_reset();
+    key(KC_LSFT, true, 0);
+    tap(KC_1);
+    key(KC_LSFT, false, 0);
+    key(KC_LCTL, true, 0);
+    tap(KC_C);
+    key(KC_LCTL, false, 0);
+    key_history_repeat();
+    CHECK_STR(stub_typed(), "!C-cC-c");
+    CHECK_INT(stub_report_mods(), 0);
+
+    // A held mod-tap is not a key, a tapped one is its key.
+    stub_reset();
+    tap(KC_D);
+    key(LCTL_T(KC_E), true, 0);
+    key(LCTL_T(KC_E), false, 0);
+    key_history_repeat();
+    key(LCTL_T(KC_E), true, 1);
+    key(LCTL_T(KC_E), false, 1);
+    key_history_repeat();
+    CHECK_STR(stub_typed(), "ddee");
+
+    // A marker replays everything its macro typed.
+    stub_reset();
+    send_arrow();
+    key_history_repeat();
+    key_history_repeat();
+    CHECK_STR(stub_typed(), "->->->");
+    CHECK_INT(key_history_get(0).keycode, ARROW);
+    CHECK_INT(key_history_get(1).keycode, ARROW);
+
+    // Magic types the continuation, sees repeats, and repeats unknown keys.
+    stub_reset();
+    tap(KC_O);
+    key_history_magic();
+    CHECK_STR(stub_typed(), "oa");
+    tap(KC_O);
+    key_history_repeat();
+    key_history_magic();
+    CHECK_STR(stub_typed(), "oaooa");
+    tap(KC_Z);
+    key_history_magic();
+    CHECK_STR(stub_typed(), "oaooazz");
+
+    // History only holds KEY_HISTORY_SIZE keys, the oldest is the marker.
+    CHECK_INT(key_history_get(KEY_HISTORY_SIZE - 1).keycode, ARROW);
+    CHECK_INT(key_history_get(KEY_HISTORY_SIZE).keycode, KC_NO);
+
+    return stub_finish("key_history");
+}
@@ -0,0 +1,98 @@
+#include "quantum.h"
+#include "features/leader_trie.h"
+
+enum
+{
+    COPY = SAFE_RANGE,
+    WIN_1,
+    WIN_SCL,
+};
+
+#include "leader_data.h"
+
+// Actions the leader dispatched, one entry per press.
+static uint16_t actions[8];
+static uint8_t actions_count;
+static uint8_t releases_count;
+
+void process_record(keyrecord_t* record)
+{
+    CHECK(record->event.type == COMBO_EVENT);
+    if(record->event.pressed)
+    {
+        actions[actions_count++ & 7] = record->keycode;
+    }
+    else
+    {
+        releases_count++;
+    }
+}
+
+// Returns true if the key was passed on.
+static bool press(uint16_t keycode, uint8_t tap_count)
+{
+    keyrecord_t record = stub_key(0, 0, true);
+    record.tap.count   = tap_count;
+    const bool passed  = process_leader_trie(keycode, &record);
+    record             = stub_key(0, 0, false);
+    process_leader_trie(keycode, &record);
+    stub_advance(50);
+    return passed;
+}
+
+static void start(void)
+{
+    stub_reset();
+    actions_count = releases_count = 0;
+    leader_trie_start();
+}
+
+int main(void)
+{
+    start();
+    CHECK(!press(KC_C, 0));
+    CHECK_INT(actions_count, 1);
+    CHECK_INT(releases_count, 1);
+    CHECK_INT(actions[0], COPY);
+    CHECK(!leader_trie_active());
+    CHECK_INT(stub_deferred_in_use(), 0);
+    CHECK(press(KC_C, 0));
+
+    start();
+    press(KC_W, 0);
+    press(KC_C, 0);
+    CHECK(leader_trie_active());
+    press(KC_L, 0);
+    CHECK_INT(actions[0], WIN_SCL);
+
+    start();
+    press(KC_G, 0);
+    press(KC_A, 0);
+    CHECK_INT(actions[0], TO(2));
+
+    // A key that continues no sequence aborts and is swallowed.
+    start();
+    press(KC_W, 0);
+    CHECK(!press(KC_X, 0));
+    CHECK(!leader_trie_active());
+    CHECK_INT(actions_count, 0);
+
+    // Tapped mod-taps are their key, held ones pass as mods.
+    start();
+    CHECK(press(LCTL_T(KC_W), 0));
+    CHECK(leader_trie_active());
+    CHECK(press(KC_LSFT, 0));
+    CHECK(!press(LCTL_T(KC_W), 1));
+    CHECK(!press(LT(1, KC_N), 1));
+    CHECK_INT(actions[0], WIN_1);
+
+    // An abandoned leader times out.
+    start();
+    press(KC_W, 0);
+    stub_advance(LEADER_TRIE_IDLE_TIMEOUT);
+    CHECK(!leader_trie_active());
+    CHECK(press(KC_N, 0));
+    CHECK_INT(actions_count, 0);
+
+    return stub_finish("leader_trie");
+}
@@ -0,0 +1,142 @@
+#include "quantum.h"
+#include "features/macro_recorder.h"
+
+// Events sent by the playback.
+typedef struct
+{
+    uint16_t keycode;
+    bool pressed;
+    uint16_t time;
+} played_t;
+
+static played_t played[128];
+static uint8_t played_count;
+
+void process_record(keyrecord_t* record)
+{
+    CHECK(record->event.type == COMBO_EVENT);
+    played[played_count++ & 127] = (played_t){record->keycode, record->event.pressed, timer_read()};
+    process_macro_recorder(record->keycode, record);
+}
+
+static void key(uint16_t keycode, bool pressed)
+{
+    keyrecord_t record = stub_key(0, 0, pressed);
+    process_macro_recorder(keycode, &record);
+}
+
+// Length of the macro saved to the EEPROM.
+static uint8_t saved_length(void)
+{
+    uint8_t length;
+    eeconfig_read_user_datablock(&length, 0, 1);
+    return length;
+}
+
+// Plays the macro to the end.
+static void play(void)
+{
+    played_count = 0;
+    macro_recorder_play();
+    stub_advance(2000);
+    CHECK_INT(stub_deferred_in_use(), 0);
+}
+
+// Time between the played events `i - 1` and `i`, 1 ms when playing fast.
+static void check_delay(uint8_t i, uint16_t delay)
+{
+#ifdef MACRO_RECORDER_FAST_PLAYBACK
+    delay = 1;
+#endif
+    CHECK_INT(played[i].time - played[i - 1].time, delay);
+}
+
+int main(void)
+{
+    stub_reset();
+    macro_recorder_init();
+
+    // Taps of the same key are repeats, one byte each even when slow.
+    macro_recorder_toggle();
+    stub_advance(10);
+    for(uint8_t i = 0; i < 3; i++)
+    {
+        key(KC_A, true);
+        stub_advance(20);
+        key(KC_A, false);
+        stub_advance(60);
+    }
+    macro_recorder_toggle();
+    CHECK_INT(saved_length(), 3 + 1 + 1 + 1);
+
+    // Played with the same rhythm.
+    play();
+    CHECK_INT(played_count, 6);
+    for(uint8_t i = 0; i < 6; i++)
+    {
+        CHECK_INT(played[i].keycode, KC_A);
+        CHECK_INT(played[i].pressed, i % 2 == 0);
+        if(i > 0)
+        {
+            check_delay(i, i % 2 ? 20 : 60);
+        }
+    }
+
+    // Loaded back from the EEPROM.
+    stub_reset();
+    macro_recorder_init();
+    play();
+    CHECK_INT(played_count, 6);
+
+    // Delays are capped, held mod-taps recorded as their mods.
+    stub_reset();
+    macro_recorder_toggle();
+    keyrecord_t record = stub_key(0, 0, true);
+    process_macro_recorder(LSFT_T(KC_B), &record);
+    stub_advance(500);
+    key(KC_C, true);
+    key(KC_C, false);
+    record = stub_key(0, 0, false);
+    process_macro_recorder(LSFT_T(KC_B), &record);
+    macro_recorder_toggle();
+    play();
+    CHECK_INT(played_count, 4);
+    CHECK_INT(played[0].keycode, LSFT(KC_NO));
+    CHECK_INT(played[1].keycode, KC_C);
+    check_delay(1, MACRO_RECORDER_MAX_DELAY);
+    CHECK_INT(played[3].keycode, LSFT(KC_NO));
+    CHECK(!played[3].pressed);
+
+    // Once full, recording stops. Only keys recorded down get a release: a
+    // held Shift, not the press that didn't fit.
+    stub_reset();
+    const uint8_t empty = 0;
+    eeconfig_update_user_datablock(&empty, 0, 1);
+    macro_recorder_toggle();
+    key(KC_LSFT, true);
+    uint8_t taps = 0;
+    for(uint16_t keycode = KC_A; saved_length() == 0; keycode = keycode == KC_A ? KC_B : KC_A)
+    {
+        key(keycode, true);
+        key(keycode, false);
+        taps++;
+    }
+    key(KC_C, true);
+    play();
+    int8_t down[256] = {0};
+    for(uint8_t i = 0; i < played_count; i++)
+    {
+        down[played[i].keycode] += played[i].pressed ? 1 : -1;
+        CHECK(down[played[i].keycode] >= 0);
+    }
+    CHECK_INT(down[KC_LSFT], 0);
+    CHECK_INT(down[KC_A] + down[KC_B], 0);
+    CHECK_INT(played[played_count - 1].keycode, KC_LSFT);
+    CHECK_INT(played_count, 1 + 2 * (taps - 1) + 1);
+
+#ifdef MACRO_RECORDER_FAST_PLAYBACK
+    return stub_finish("macro_recorder_fast");
+#else
+    return stub_finish("macro_recorder");
+#endif
+}
@@ -0,0 +1,108 @@
+#include "quantum.h"
+#include "features/mod_session.h"
+
+enum
+{
+    ALTTAB = SAFE_RANGE,
+    CTLTAB,
+    CTLPGDN,
+};
+
+const mod_session_t mod_sessions[] = {
+    {ALTTAB, KC_TAB, MOD_BIT(KC_LALT), 1000},
+    {CTLTAB, KC_TAB, MOD_BIT(KC_LCTL), 1000},
+    {CTLPGDN, KC_PGDN, MOD_BIT(KC_LCTL), 500},
+};
+const uint8_t mod_sessions_count = ARRAY_SIZE(mod_sessions);
+
+void process_record(keyrecord_t* record) {}
+
+// Runs a key through the session handler and then QMK's default action. A
+// mod-tap is passed as a hold, its mods registered like the action layer does.
+static void key(uint16_t keycode, bool pressed)
+{
+    keyrecord_t record = stub_key(0, 0, pressed);
+    if(process_mod_session(keycode, &record))
+    {
+        if(IS_QK_MOD_TAP(keycode))
+        {
+            const uint8_t mods = QK_MOD_TAP_GET_MODS(keycode);
+            pressed ? register_mods(mods) : unregister_mods(mods);
+        }
+        else
+        {
+            stub_default_action(keycode, &record);
+        }
+    }
+}
+
+static void tap(uint16_t keycode)
+{
+    key(keycode, true);
+    key(keycode, false);
+}
+
+int main(void)
+{
+    // A session holds its mod until the timeout after the last press.
+    stub_reset();
+    tap(ALTTAB);
+    stub_advance(600);
+    tap(ALTTAB);
+    CHECK_STR(stub_typed(), "A-\tA-\t");
+    CHECK_INT(stub_deferred_in_use(), 1);
+    stub_advance(999);
+    CHECK_INT(stub_report_mods(), MOD_BIT(KC_LALT));
+    stub_advance(1);
+    CHECK_INT(stub_report_mods(), 0);
+    CHECK_INT(mod_session_active(), 0);
+    CHECK_INT(stub_deferred_in_use(), 0);
+
+    // Another key ends the session before it is typed.
+    stub_reset();
+    tap(ALTTAB);
+    tap(KC_A);
+    CHECK_STR(stub_typed(), "A-\ta");
+    CHECK_INT(stub_deferred_in_use(), 0);
+
+    // Shift doesn't end it, so it can reverse the direction.
+    stub_reset();
+    tap(ALTTAB);
+    key(KC_LSFT, true);
+    tap(ALTTAB);
+    key(KC_LSFT, false);
+    CHECK_STR(stub_typed(), "A-\tA-\t");
+    CHECK_INT(mod_session_active(), 1);
+    mod_session_end_all();
+
+    // A physically held Alt survives the end of the session.
+    stub_reset();
+    key(LALT_T(KC_A), true);
+    tap(ALTTAB);
+    tap(KC_B);
+    CHECK_INT(stub_report_mods(), MOD_BIT(KC_LALT));
+    key(LALT_T(KC_A), false);
+    CHECK_INT(stub_report_mods(), 0);
+
+    stub_reset();
+    key(KC_LALT, true);
+    tap(ALTTAB);
+    stub_advance(1000);
+    CHECK_INT(mod_session_active(), 0);
+    CHECK_INT(stub_report_mods(), MOD_BIT(KC_LALT));
+    key(KC_LALT, false);
+    CHECK_INT(stub_report_mods(), 0);
+
+    // Ctrl stays while one of the two sessions using it runs.
+    stub_reset();
+    tap(CTLTAB);
+    tap(CTLPGDN);
+    CHECK_INT(stub_deferred_in_use(), 2);
+    stub_advance(500);
+    CHECK_INT(mod_session_active(), 1 << 1);
+    CHECK_INT(stub_report_mods(), MOD_BIT(KC_LCTL));
+    stub_advance(500);
+    CHECK_INT(stub_report_mods(), 0);
+
+    return stub_finish("mod_session");
+}
@@ -0,0 +1,83 @@
+#include "quantum.h"
+#include "features/mouse_curve.h"
+
+void process_record(keyrecord_t* record) {}
+
+// Holds the directions for `ms` in steps of `step` ms and returns the pixels moved.
+static int32_t move(mouse_curve_t* curve, int8_t dir_x, int8_t dir_y, bool precise, uint16_t ms, uint16_t step, int32_t* moved_y)
+{
+    int32_t total_x = 0;
+    int32_t total_y = 0;
+    for(uint16_t t = 0; t < ms; t += step)
+    {
+        int8_t x;
+        int8_t y;
+        mouse_curve_step(curve, dir_x, dir_y, precise, step, &x, &y);
+        total_x += x;
+        total_y += y;
+    }
+    if(moved_y)
+    {
+        *moved_y = total_y;
+    }
+    return total_x;
+}
+
+int main(void)
+{
+    // Jumps to the start speed and accelerates linearly to the max speed.
+    mouse_curve_t curve = {0};
+    move(&curve, 1, 0, false, 1, 1, NULL);
+    CHECK_INT(curve.velocity_x, MOUSE_CURVE_START_SPEED + MOUSE_CURVE_ACCEL);
+    move(&curve, 1, 0, false, 99, 1, NULL);
+    CHECK_INT(curve.velocity_x, MOUSE_CURVE_START_SPEED + 100 * MOUSE_CURVE_ACCEL);
+    move(&curve, 1, 0, false, 1000, 1, NULL);
+    CHECK_INT(curve.velocity_x, MOUSE_CURVE_MAX_SPEED);
+    CHECK_INT(curve.velocity_y, 0);
+
+    // The distance hardly depends on the scan rate.
+    mouse_curve_t fine   = {0};
+    mouse_curve_t coarse = {0};
+    const int32_t fine_x   = move(&fine, 1, 0, false, 800, 1, NULL);
+    const int32_t coarse_x = move(&coarse, 1, 0, false, 800, 8, NULL);
+    CHECK(fine_x > 1000);
+    CHECK(coarse_x - fine_x <= 8 && fine_x - coarse_x <= 8);
+
+    // Directions are symmetric.
+    mouse_curve_t left = {0};
+    CHECK_INT(move(&left, -1, 0, false, 800, 1, NULL), -fine_x);
+
+    // Diagonals are not faster than straight moves.
+    mouse_curve_t diagonal = {0};
+    int32_t diagonal_y;
+    const int32_t diagonal_x = move(&diagonal, 1, 1, false, 2000, 1, &diagonal_y);
+    CHECK_INT(diagonal.velocity_x, MOUSE_CURVE_MAX_SPEED * MOUSE_CURVE_DIAGONAL / 256);
+    CHECK_INT(diagonal.velocity_y, diagonal.velocity_x);
+    CHECK_INT(diagonal_x, diagonal_y);
+
+    // Precision mode lowers the max speed.
+    mouse_curve_t precise = {0};
+    move(&precise, 0, 1, true, 5000, 1, NULL);
+    CHECK_INT(precise.velocity_y, MOUSE_CURVE_MAX_SPEED * MOUSE_CURVE_PRECISION / 256);
+
+    // Reversing starts over from the start speed.
+    move(&curve, -1, 0, false, 1, 1, NULL);
+    CHECK_INT(curve.velocity_x, -(MOUSE_CURVE_START_SPEED + MOUSE_CURVE_ACCEL));
+
+    // Released, it glides a little further and stops.
+    move(&curve, 1, 0, false, 1000, 1, NULL);
+    const int32_t glide = move(&curve, 0, 0, false, 500, 1, NULL);
+    CHECK(glide > 0 && glide < 50);
+    CHECK(!mouse_curve_moving(&curve));
+    CHECK_INT(curve.remainder_x, 0);
+
+    // A stalled scan moves at most one long step.
+    mouse_curve_t stalled = {0};
+    move(&stalled, 1, 0, false, 1000, 1, NULL);
+    int8_t x;
+    int8_t y;
+    mouse_curve_step(&stalled, 1, 0, false, 1000, &x, &y);
+    CHECK_INT(x, MOUSE_CURVE_MAX_SPEED * MOUSE_CURVE_MAX_STEP / 256);
+
+    return stub_finish("mouse_curve");
+}
@@ -0,0 +1,121 @@
+#include "quantum.h"
+#include "features/report_coalesce.h"
+
+void process_record(keyrecord_t* record) {}
+
+static void shortcut(void)
+{
+    tap_code16(LCTL(KC_C));
+}
+
+// DOT_ARROW with Shift held, as keymap.c sends it.
+static void arrow(void)
+{
+    const uint8_t mods = get_mods();
+    del_mods(MOD_MASK_SHIFT);
+    tap_code(KC_MINS);
+    tap_code16(KC_GT);
+    set_mods(mods);
+    send_keyboard_report();
+}
+
+static void double_tap(void)
+{
+    tap_code(KC_A);
+    tap_code(KC_A);
+}
+
+static void mod_tap(void)
+{
+    register_code(KC_LGUI);
+    unregister_code(KC_LGUI);
+}
+
+static void roll(void)
+{
+    register_code(KC_A);
+    register_code(KC_B);
+    unregister_code(KC_A);
+    unregister_code(KC_B);
+}
+
+// Reports the host got during `scenario`, with `mods` held around it.
+static uint16_t run(void (*scenario)(void), uint8_t mods, bool coalesce, stub_report_t* reports, char* typed)
+{
+    stub_reset();
+    if(coalesce)
+    {
+        // Installs the driver, as the first scan after boot does.
+        report_coalesce_begin();
+        report_coalesce_end();
+    }
+    register_mods(mods);
+    const uint16_t first = stub_report_count;
+    stub_clear_typed();
+    if(coalesce)
+    {
+        report_coalesce_begin();
+    }
+    scenario();
+    if(coalesce)
+    {
+        report_coalesce_end();
+    }
+    const uint16_t count = stub_report_count - first;
+    memcpy(reports, &stub_reports[first], count * sizeof(*reports));
+    strcpy(typed, stub_typed());
+    unregister_mods(mods);
+    return count;
+}
+
+// Runs `scenario` without and with coalescing. The host must type the same
+// text and only see reports that were also sent without coalescing, in the
+// same order, ending on the same one.
+static void compare(void (*scenario)(void), uint8_t mods, uint16_t expected_before, uint16_t expected_after)
+{
+    stub_report_t before[32];
+    stub_report_t after[32];
+    char typed_before[32];
+    char typed_after[32];
+    const uint16_t before_count = run(scenario, mods, false, before, typed_before);
+    const uint16_t after_count  = run(scenario, mods, true, after, typed_after);
+    CHECK_INT(before_count, expected_before);
+    CHECK_INT(after_count, expected_after);
+    CHECK_STR(typed_after, typed_before);
+
+    uint16_t i = 0;
+    for(uint16_t j = 0; j < after_count; j++)
+    {
+        while(i < before_count && memcmp(&before[i], &after[j], sizeof(after[j])) != 0)
+        {
+            i++;
+        }
+        CHECK(i < before_count);
+        i++;
+    }
+    CHECK(memcmp(&before[before_count - 1], &after[after_count - 1], sizeof(after[0])) == 0);
+}
+
+int main(void)
+{
+    // Ctrl+C, nothing.
+    compare(shortcut, 0, 4, 2);
+    // "-", nothing, Shift+., nothing, Shift.
+    compare(arrow, MOD_BIT(KC_LSFT), 7, 5);
+
+    // Nothing to merge: every tap is sent, rolled keys keep their order.
+    compare(double_tap, 0, 4, 4);
+    compare(mod_tap, 0, 2, 2);
+    compare(roll, 0, 4, 4);
+
+    // Outside a pass, reports go out at once.
+    stub_reset();
+    report_coalesce_begin();
+    report_coalesce_end();
+    register_code16(LCTL(KC_C));
+    CHECK_INT(stub_report_count, 2);
+    unregister_code16(LCTL(KC_C));
+    CHECK_INT(stub_report_count, 4);
+
+    return stub_finish("report_coalesce");
+}
@@ -0,0 +1,144 @@
+#include "quantum.h"
+#include "features/split_timestamps.h"
+#include "transactions.h"
+
+// The matrix rows both halves read, and the slave's side of the RPC: either
+// the real handler, or a message the test writes as the slave would.
+static matrix_row_t matrix[MATRIX_ROWS];
+static slave_callback_t handler;
+static uint8_t slave_msg[RPC_S2M_BUFFER_SIZE];
+
+void process_record(keyrecord_t* record) {}
+
+matrix_row_t matrix_get_row(uint8_t row)
+{
+    return matrix[row];
+}
+
+void transaction_register_rpc(int8_t transaction_id, slave_callback_t callback)
+{
+    handler = callback;
+}
+
+bool transaction_rpc_recv(int8_t transaction_id, uint8_t target2initiator_buffer_size, void* target2initiator_buffer)
+{
+    memcpy(target2initiator_buffer, slave_msg, target2initiator_buffer_size);
+    memset(slave_msg, 0, sizeof(slave_msg));
+    return true;
+}
+
+// A key of the right half, the slave, changed at `time` on the shared clock.
+static void slave_log(uint8_t row, uint8_t col, bool pressed, uint16_t time)
+{
+    uint8_t* change = &slave_msg[1 + 3 * slave_msg[0]++];
+    change[0]       = (row * MATRIX_COLS + col) | (pressed ? 0x80 : 0);
+    change[1]       = time & 0xFF;
+    change[2]       = time >> 8;
+    matrix[MATRIX_ROWS / 2 + row] ^= 1 << col;
+}
+
+// The same, read by the master on its next scan.
+static void slave_change(uint8_t row, uint8_t col, bool pressed, uint16_t time)
+{
+    slave_log(row, col, pressed, time);
+    split_timestamps_master_scan();
+}
+
+// Time of a key event once it went through the module.
+static uint16_t event(uint8_t row, uint8_t col, bool pressed)
+{
+    keyrecord_t record = stub_key(row, col, pressed);
+    pre_process_split_timestamps(KC_A, &record);
+    return record.event.time;
+}
+
+int main(void)
+{
+    stub_reset();
+    split_timestamps_init();
+
+    // A slave key gets the time it was logged at.
+    stub_now = 2000;
+    slave_change(0, 1, true, 1981);
+    stub_advance(10);
+    CHECK_INT(event(4, 1, true), 1981);
+
+    // Releases too.
+    slave_change(0, 1, false, 2011);
+    stub_advance(10);
+    CHECK_INT(event(4, 1, false), 2011);
+
+    // Never before the event passed on ahead of it.
+    stub_advance(10);
+    CHECK_INT(event(0, 0, true), 2031);
+    slave_change(0, 2, true, 2015);
+    stub_advance(10);
+    CHECK_INT(event(4, 2, true), 2031);
+
+    // Stale times are ignored.
+    slave_change(0, 3, true, 1981);
+    stub_advance(10);
+    CHECK_INT(event(4, 3, true), 2051);
+
+    // Master keys keep their time.
+    CHECK_INT(event(0, 1, true), 2051);
+
+    // The skew taken out of a slave key: pressed 20 ms before the master
+    // fetched it and held 60 ms, a master key pressed 30 ms after it. Left
+    // alone the master would see 10 ms and 44 ms.
+    stub_advance(1000);
+    const uint16_t down = stub_now | 1;
+    stub_advance(20);
+    slave_change(0, 0, true, down);
+    CHECK_INT(event(4, 0, true), down);
+    stub_advance(10);
+    CHECK_INT(TIMER_DIFF_16(event(0, 2, true), down), 30);
+    stub_advance(35);
+    slave_change(0, 0, false, down + 60);
+    CHECK_INT(TIMER_DIFF_16(event(4, 0, false), down), 60);
+
+    // Long after the last event, its time doesn't hold a restamp back.
+    stub_advance(40000);
+    slave_change(0, 4, true, (uint16_t)(stub_now - 20) | 1);
+    CHECK_INT(event(4, 4, true), (uint16_t)(stub_now - 20) | 1);
+
+    // No fetch on the scan that sees a press, as in the idle scheduler's
+    // slow stage: the press keeps the master's time. Its change comes with
+    // the next fetch and leaves the release alone.
+    stub_advance(60000);
+    slave_log(0, 0, true, stub_now);
+    stub_advance(10);
+    CHECK_INT(event(4, 0, true), (uint16_t)stub_now | 1);
+    stub_advance(1);
+    split_timestamps_master_scan();
+    stub_advance(80);
+    const uint16_t released = stub_now;
+    slave_change(0, 0, false, released);
+    stub_advance(10);
+    CHECK_INT(event(4, 0, false), released);
+
+    // The slave logs its changes with the time, the oldest dropped when the
+    // master doesn't fetch them in time. A fetch empties the log.
+    stub_reset();
+    stub_master = false;
+    memset(matrix, 0, sizeof(matrix));
+    split_timestamps_slave_scan();
+    for(uint8_t col = 0; col < MATRIX_COLS; col++)
+    {
+        stub_advance(1);
+        matrix[0] |= 1 << col;
+        matrix[1] |= 1 << col;
+        split_timestamps_slave_scan();
+    }
+    uint8_t msg[RPC_S2M_BUFFER_SIZE];
+    handler(0, NULL, sizeof(msg), msg);
+    CHECK_INT(msg[0], SPLIT_TIMESTAMPS_MAX);
+    CHECK_INT(msg[1], 1 | 0x80);
+    CHECK_INT(msg[2] | msg[3] << 8, 1003);
+    CHECK_INT(msg[1 + 3 * 7], (MATRIX_COLS + 4) | 0x80);
+    CHECK_INT(msg[2 + 3 * 7] | msg[3 + 3 * 7] << 8, 1005);
+    handler(0, NULL, sizeof(msg), msg);
+    CHECK_INT(msg[0], 0);
+
+    return stub_finish("split_timestamps");
+}
@@ -0,0 +1,124 @@
+#include "quantum.h"
+#include "features/text_expansion.h"
+
+void process_record(keyrecord_t* record) {}
+
+// Number of keys the handler let through to the rest of the pipeline.
+static int passed;
+
+static void tap(uint16_t keycode)
+{
+    keyrecord_t record = stub_key(0, 0, true);
+    if(process_text_expansion(keycode, &record))
+    {
+        passed++;
+        stub_default_action(keycode, &record);
+    }
+    record = stub_key(0, 0, false);
+    if(process_text_expansion(keycode, &record))
+    {
+        stub_default_action(keycode, &record);
+    }
+    stub_advance(20);
+}
+
+static void type(const char* text)
+{
+    for(; *text; text++)
+    {
+        switch(*text)
+        {
+        case ' ':
+            tap(KC_SPC);
+            break;
+        case ',':
+            tap(KC_COMM);
+            break;
+        case '\b':
+            tap(KC_BSPC);
+            break;
+        default:
+            tap(KC_A + *text - 'a');
+            break;
+        }
+    }
+}
+
+// Applies the backspaces in what the host received.
+static const char* text(void)
+{
+    static char result[256];
+    size_t length = 0;
+    for(const char* c = stub_typed(); *c; c++)
+    {
+        if(*c == '\b')
+        {
+            length -= length > 0;
+        }
+        else if(length < sizeof(result) - 1)
+        {
+            result[length++] = *c;
+        }
+    }
+    result[length] = '\0';
+    return result;
+}
+
+static void start(void)
+{
+    stub_reset();
+    type(" ");
+    passed = 0;
+}
+
+int main(void)
+{
+    start();
+    type("teh ");
+    CHECK_STR(text(), " the ");
+    // The boundary key continues through the pipeline, so key overrides
+    // and the rest of process_record_user() see it.
+    CHECK_INT(passed, 4);
+
+    start();
+    type("adn,");
+    CHECK_STR(text(), " and,");
+
+    // Boundaries on both sides, so no match inside a word.
+    start();
+    type("tehx ");
+    CHECK_STR(text(), " tehx ");
+
+    // A match without a trailing boundary swallows the completing key.
+    start();
+    type("whcih");
+    CHECK_STR(text(), " which");
+    type(" ");
+    CHECK_STR(text(), " which ");
+
+    start();
+    type("ouput ");
+    CHECK_STR(text(), " output ");
+    start();
+    type("the ouput ");
+    CHECK_STR(text(), " the output ");
+
+    start();
+    type("btw ");
+    CHECK_STR(text(), " by the way ");
+
+    // Backspace keeps the buffer in step with the text.
+    start();
+    type("tex\bh ");
+    CHECK_STR(text(), " the ");
+
+    // Other mods than Shift pause matching.
+    start();
+    register_mods(MOD_BIT(KC_LCTL));
+    type("teh");
+    unregister_mods(MOD_BIT(KC_LCTL));
+    type(" ");
+    CHECK_STR(stub_typed(), " C-tC-eC-h ");
+
+    return stub_finish("text_expansion");
+}
@@ -0,0 +1,155 @@
+#include "quantum.h"
+#include "features/text_expansion.h"
+#include "text_expansion_data.h"
+
+#include <time.h>
+
+// Lookup cost on a generated dictionary of BENCH_ENTRIES entries, built from
+// BENCH_DICT by make_bench_dict.py. Every typo of the dictionary is typed and
+// must expand, then words that match nothing are typed for the cost of a
+// miss. Times cover process_text_expansion() alone, the keys it sends on a
+// match included.
+
+void process_record(keyrecord_t* record) {}
+
+typedef struct
+{
+    char typo[32];
+    char replacement[32];
+} entry_t;
+
+static entry_t entries[BENCH_ENTRIES];
+
+static void load(void)
+{
+    FILE* file = fopen(BENCH_DICT, "r");
+    CHECK(file != NULL);
+    char line[128];
+    uint16_t count = 0;
+    while(file && fgets(line, sizeof(line), file))
+    {
+        if(line[0] != '#' && count < BENCH_ENTRIES &&
+           sscanf(line, "%31s -> %31s", entries[count].typo, entries[count].replacement) == 2)
+        {
+            count++;
+        }
+    }
+    if(file)
+    {
+        fclose(file);
+    }
+    CHECK_INT(count, BENCH_ENTRIES);
+}
+
+static uint64_t taken;  // ns
+static uint32_t keys;
+
+static uint64_t now_ns(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (uint64_t)time.tv_sec * 1000000000 + time.tv_nsec;
+}
+
+static void tap(uint16_t keycode)
+{
+    keyrecord_t record = stub_key(0, 0, true);
+    const uint64_t start = now_ns();
+    const bool passed    = process_text_expansion(keycode, &record);
+    taken += now_ns() - start;
+    keys++;
+    if(passed)
+    {
+        stub_default_action(keycode, &record);
+    }
+    record = stub_key(0, 0, false);
+    stub_default_action(keycode, &record);
+}
+
+// Types `word`, a ':' as a space.
+static void type(const char* word)
+{
+    for(; *word; word++)
+    {
+        tap(*word == ':' ? KC_SPC : KC_A + *word - 'a');
+    }
+}
+
+// The text the host ended up with, backspaces applied.
+static const char* text(void)
+{
+    static char result[64];
+    size_t length = 0;
+    for(const char* c = stub_typed(); *c; c++)
+    {
+        if(*c == '\b')
+        {
+            length -= length > 0;
+        }
+        else if(length < sizeof(result) - 1)
+        {
+            result[length++] = *c;
+        }
+    }
+    result[length] = '\0';
+    return result;
+}
+
+static uint32_t ns_per_key(void)
+{
+    const uint32_t ns = taken / keys;
+    taken             = 0;
+    keys              = 0;
+    return ns;
+}
+
+int main(void)
+{
+    load();
+    stub_reset();
+
+    uint32_t expanded = 0;
+    for(uint16_t i = 0; i < BENCH_ENTRIES; i++)
+    {
+        const entry_t* entry = &entries[i];
+        type(" ");
+        stub_clear_typed();
+        type(entry->typo + 1);
+        // A word start swallows its last key, a whole word types the space.
+        char expected[40];
+        snprintf(expected, sizeof(expected), "%s%s", entry->replacement, entry->typo[strlen(entry->typo) - 1] == ':' ? " " : "");
+        if(strcmp(text(), expected) == 0)
+        {
+            expanded++;
+        }
+        else
+        {
+            CHECK_STR(text(), expected);
+        }
+    }
+    CHECK_INT(expanded, BENCH_ENTRIES);
+    const uint32_t hit_ns = ns_per_key();
+
+    // Plain words, each key a miss, the walk as deep as the typos let it.
+    uint32_t rng = 1;
+    for(uint32_t i = 0; i < 20000; i++)
+    {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        tap(rng % 6 ? KC_E + rng % 20 : KC_SPC);
+        if(i % 1000 == 0)
+        {
+            stub_clear_typed();
+        }
+    }
+    const uint32_t miss_ns = ns_per_key();
+
+    // Generous: a lookup walks at most TEXT_EXPANSION_MAX_LENGTH nodes.
+    CHECK(hit_ns < 5000 && miss_ns < 5000);
+    printf("text_expansion_bench_%d: %d entries, %d bytes, %u ns per key of a typo, %u ns per key of other words\n",
+           BENCH_ENTRIES, BENCH_ENTRIES, (int)sizeof(text_expansion_data), hit_ns, miss_ns);
+    char name[32];
+    snprintf(name, sizeof(name), "text_expansion_bench_%d", BENCH_ENTRIES);
+    return stub_finish(name);
+}
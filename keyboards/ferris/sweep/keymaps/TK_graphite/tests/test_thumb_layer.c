@@ -0,0 +1,202 @@
+#include "quantum.h"
+#include "features/thumb_layer.h"
+
+enum
+{
+    NAV_HOLD = SAFE_RANGE,
+    SYM_HOLD,
+};
+
+enum
+{
+    BASE,
+    NAV,
+    SYM,
+};
+
+// Top row letters, NAV arrows on the same keys. The thumbs are on row 3 of
+// each half.
+static const uint16_t keymap[][MATRIX_ROWS][MATRIX_COLS] = {
+    [BASE] = {[0] = {KC_A, KC_B, KC_C, KC_D, KC_E}, [3] = {NAV_HOLD}, [7] = {SYM_HOLD}},
+    [NAV]  = {[0] = {KC_LEFT, KC_DOWN, KC_UP, KC_RGHT, KC_E}},
+    [SYM]  = {[0] = {KC_1, KC_2, KC_3, KC_4, KC_5}},
+};
+
+const thumb_layer_t thumb_layers[] = {
+    {NAV_HOLD, KC_SPC, NAV},
+    {SYM_HOLD, KC_ENT, SYM},
+};
+const uint8_t thumb_layers_count = ARRAY_SIZE(thumb_layers);
+
+// Keys of the last column always tap.
+bool thumb_layer_chord_user(const thumb_layer_t* thumb, keyrecord_t* thumb_record, uint16_t other_keycode, keyrecord_t* other_record)
+{
+    return other_record->event.key.col != 4;
+}
+
+// Looks the keycode up on the highest layer on, like QMK does for a press,
+// empty keys falling through. Releases use the layer of their press.
+static uint8_t press_layers[MATRIX_ROWS][MATRIX_COLS];
+
+static uint8_t key_layer(keypos_t key)
+{
+    uint8_t layer = get_highest_layer(layer_state);
+    while(layer && !keymap[layer][key.row][key.col])
+    {
+        layer--;
+    }
+    return layer;
+}
+
+void process_record(keyrecord_t* record)
+{
+    uint16_t keycode = record->keycode;
+    if(IS_KEYEVENT(record->event))
+    {
+        const keypos_t key = record->event.key;
+        if(record->event.pressed)
+        {
+            press_layers[key.row][key.col] = key_layer(key);
+        }
+        keycode = keymap[press_layers[key.row][key.col]][key.row][key.col];
+    }
+    if(process_thumb_layer(keycode, record))
+    {
+        stub_default_action(keycode, record);
+    }
+}
+
+static void key(uint8_t row, uint8_t col, bool pressed)
+{
+    keyrecord_t record = stub_key(row, col, pressed);
+    process_record(&record);
+}
+
+static void start(void)
+{
+    stub_reset();
+    stub_on_tick = thumb_layer_task;
+    stub_advance(1000);  // Out of any streak.
+}
+
+int main(void)
+{
+    // Tapped alone.
+    start();
+    key(3, 0, true);
+    stub_advance(50);
+    key(3, 0, false);
+    CHECK_STR(stub_typed(), " ");
+
+    // Held alone past the tap term, nothing.
+    start();
+    key(3, 0, true);
+    stub_advance(THUMB_LAYER_TAP_TERM);
+    key(3, 0, false);
+    CHECK_STR(stub_typed(), "");
+
+    // Rolled: the thumb released first is a tap, sent before the key.
+    start();
+    key(3, 0, true);
+    stub_advance(120);
+    key(0, 0, true);
+    CHECK_STR(stub_typed(), "");
+    stub_advance(30);
+    key(3, 0, false);
+    key(0, 0, false);
+    CHECK_STR(stub_typed(), " a");
+    CHECK_INT(layer_state, 0);
+
+    // Chorded: the other key released first is a hold, the key is looked up
+    // on the layer.
+    start();
+    key(3, 0, true);
+    stub_advance(120);
+    key(0, 0, true);
+    stub_advance(30);
+    key(0, 0, false);
+    CHECK_STR(stub_typed(), "[50]");
+    CHECK_INT(layer_state, 1 << NAV);
+    CHECK_INT(stub_reports[stub_report_count - 1].keys[0], 0);
+    key(3, 0, false);
+    CHECK_INT(layer_state, 0);
+
+    // A third key settles a hold.
+    start();
+    key(3, 0, true);
+    key(0, 0, true);
+    key(0, 1, true);
+    CHECK_STR(stub_typed(), "[50][51]");
+    key(0, 0, false);
+    key(0, 1, false);
+    key(3, 0, false);
+
+    // So do both keys down together for the overlap, long before the tap
+    // term. Key times are odd, the key goes down on an odd millisecond.
+    start();
+    key(3, 0, true);
+    stub_advance(21);
+    key(0, 2, true);
+    stub_advance(THUMB_LAYER_OVERLAP - 1);
+    CHECK_STR(stub_typed(), "");
+    stub_advance(1);
+    CHECK_STR(stub_typed(), "[52]");
+    CHECK(THUMB_LAYER_OVERLAP < THUMB_LAYER_TAP_TERM);
+    key(0, 2, false);
+    key(3, 0, false);
+    CHECK_STR(stub_typed(), "[52]");
+
+    // The thumb released just inside the overlap is still a roll, with the
+    // thumb held longer than the overlap.
+    start();
+    key(3, 0, true);
+    stub_advance(150);
+    key(0, 2, true);
+    stub_advance(THUMB_LAYER_OVERLAP - 1);
+    key(3, 0, false);
+    key(0, 2, false);
+    CHECK_STR(stub_typed(), " c");
+    CHECK_INT(layer_state, 0);
+
+    // A key pressed after the thumb was held alone past the tap term.
+    start();
+    key(3, 0, true);
+    stub_advance(THUMB_LAYER_TAP_TERM);
+    key(0, 3, true);
+    CHECK_STR(stub_typed(), "[4F]");
+    key(0, 3, false);
+    key(3, 0, false);
+
+    // The callback taps right away.
+    start();
+    key(3, 0, true);
+    key(0, 4, true);
+    CHECK_STR(stub_typed(), " e");
+    key(0, 4, false);
+    key(3, 0, false);
+    CHECK_STR(stub_typed(), " e");
+
+    // Mid-word the thumb taps on press.
+    start();
+    key(0, 1, true);
+    key(0, 1, false);
+    stub_advance(THUMB_LAYER_STREAK_TERM - 1);
+    key(3, 0, true);
+    CHECK_STR(stub_typed(), "b ");
+    key(0, 2, true);
+    key(0, 2, false);
+    key(3, 0, false);
+    CHECK_STR(stub_typed(), "b c");
+
+    // Two thumbs together: the first one is held.
+    start();
+    key(3, 0, true);
+    key(7, 0, true);
+    CHECK_INT(layer_state, 1 << NAV);
+    key(7, 0, false);
+    key(3, 0, false);
+    CHECK_STR(stub_typed(), "\n");
+    CHECK_INT(layer_state, 0);
+
+    return stub_finish("thumb_layer");
+}
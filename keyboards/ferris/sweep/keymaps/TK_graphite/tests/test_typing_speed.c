@@ -0,0 +1,96 @@
+#include "quantum.h"
+#include "features/typing_speed.h"
+
+void process_record(keyrecord_t* record) {}
+
+// A press `gap` ms after the previous one, stamped `early` ms before now as
+// the split timestamps do for the other half.
+static void press_early(uint16_t gap, uint16_t early)
+{
+    stub_now += gap;
+    keyrecord_t record = stub_key(0, 0, true);
+    record.event.time  = timer_read() - early;
+    pre_process_typing_speed(KC_A, &record);
+    record = stub_key(0, 0, false);
+    pre_process_typing_speed(KC_A, &record);
+}
+
+static void press(uint16_t gap)
+{
+    press_early(gap, 0);
+}
+
+// Presses `count` keys `gap` ms apart.
+static void type(uint8_t count, uint16_t gap)
+{
+    for(uint8_t i = 0; i < count; i++)
+    {
+        press(gap);
+    }
+}
+
+int main(void)
+{
+    stub_reset();
+
+    // Nothing until TYPING_SPEED_MIN_SAMPLES intervals are in.
+    type(TYPING_SPEED_MIN_SAMPLES, 100);
+    CHECK_INT(typing_speed_wpm(), 0);
+    press(100);
+    CHECK_INT(typing_speed_interval(), 100);
+    CHECK_INT(typing_speed_wpm(), 120);
+    // Stamped 1 ms ahead of the clock, as on an even millisecond.
+    stub_now += 100;
+    keyrecord_t ahead = stub_key(0, 0, true);
+    ahead.event.time  = timer_read() + 1;
+    pre_process_typing_speed(KC_A, &ahead);
+    CHECK_INT(typing_speed_wpm(), 120);
+
+    // The window keeps the last TYPING_SPEED_WINDOW intervals.
+    type(TYPING_SPEED_WINDOW, 100);
+    type(TYPING_SPEED_WINDOW / 2, 50);
+    CHECK_INT(typing_speed_interval(), 75);
+    CHECK_INT(typing_speed_wpm(), 160);
+    type(TYPING_SPEED_WINDOW / 2, 50);
+    CHECK_INT(typing_speed_wpm(), 240);
+
+    // Releases and combo events don't count.
+    stub_now += 10;
+    keyrecord_t record = {.event = MAKE_COMBOEVENT(true)};
+    pre_process_typing_speed(KC_A, &record);
+    press(40);
+    CHECK_INT(typing_speed_interval(), 50);
+
+    // Not typing once the last press is TYPING_SPEED_MAX_GAP old.
+    stub_now += TYPING_SPEED_MAX_GAP;
+    CHECK_INT(typing_speed_wpm(), 240);
+    stub_now += 1;
+    CHECK_INT(typing_speed_wpm(), 0);
+
+    // A longer pause starts a new burst.
+    press(TYPING_SPEED_MAX_GAP);
+    type(TYPING_SPEED_MIN_SAMPLES - 1, 200);
+    CHECK_INT(typing_speed_wpm(), 0);
+    press(200);
+    CHECK_INT(typing_speed_interval(), 200);
+
+    // A press restamped before the last one came down with it: a 0 ms
+    // interval, not a pause.
+    press(TYPING_SPEED_MAX_GAP + 1);
+    type(TYPING_SPEED_MIN_SAMPLES, 100);
+    press_early(10, 30);
+    CHECK_INT(typing_speed_interval(), 80);
+    press(100);
+    CHECK_INT(typing_speed_interval(), 85);
+
+    // Only simultaneous presses, the fastest interval.
+    press(TYPING_SPEED_MAX_GAP + 1);
+    for(uint8_t i = 0; i < TYPING_SPEED_WINDOW; i++)
+    {
+        press_early(1, 1 + i);
+    }
+    CHECK_INT(typing_speed_interval(), 1);
+    CHECK_INT(typing_speed_wpm(), 12000);
+
+    return stub_finish("typing_speed");
+}
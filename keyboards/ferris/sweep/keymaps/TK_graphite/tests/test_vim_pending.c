@@ -0,0 +1,113 @@
+#include "quantum.h"
+#include "features/vim_pending.h"
+
+#define NAV_LAYER 1
+
+void process_record(keyrecord_t* record) {}
+
+bool vim_pending_enabled_user(void)
+{
+    return IS_LAYER_ON(NAV_LAYER);
+}
+
+static void tap(uint16_t keycode)
+{
+    keyrecord_t record = stub_key(0, 0, true);
+    if(process_vim_pending(keycode, &record))
+    {
+        stub_default_action(keycode, &record);
+    }
+    stub_advance(10);
+    record = stub_key(0, 0, false);
+    if(process_vim_pending(keycode, &record))
+    {
+        stub_default_action(keycode, &record);
+    }
+    stub_advance(10);
+}
+
+static void start(void)
+{
+    stub_reset();
+    layer_on(NAV_LAYER);
+}
+
+int main(void)
+{
+    // Count, operator and motion go out together once the motion arrives.
+    start();
+    tap(KC_KP_3);
+    tap(KC_D);
+    CHECK_STR(stub_typed(), "");
+    tap(KC_W);
+    CHECK_STR(stub_typed(), "3dw");
+
+    // An operator without a count is sent right away, e.g. yank a selection.
+    start();
+    tap(KC_Y);
+    CHECK_STR(stub_typed(), "y");
+    tap(KC_Y);
+    CHECK_STR(stub_typed(), "yy");
+
+    start();
+    tap(KC_KP_2);
+    tap(KC_D);
+    tap(KC_D);
+    CHECK_STR(stub_typed(), "2dd");
+
+    // A count typed after the operator still reaches the motion.
+    start();
+    tap(KC_D);
+    tap(KC_KP_1);
+    tap(KC_KP_2);
+    tap(KC_E);
+    CHECK_STR(stub_typed(), "d12e");
+
+    // Shift held while typing the count doesn't change the digits.
+    start();
+    register_mods(MOD_BIT(KC_LSFT));
+    tap(KC_KP_1);
+    tap(KC_KP_0);
+    unregister_mods(MOD_BIT(KC_LSFT));
+    tap(KC_W);
+    CHECK_STR(stub_typed(), "10w");
+
+    // A leading 0 is a motion.
+    start();
+    tap(KC_KP_0);
+    CHECK_STR(stub_typed(), "0");
+
+    // Repeats of a motion collapse into a count.
+    start();
+    tap(KC_W);
+    tap(KC_W);
+    tap(KC_W);
+    CHECK_STR(stub_typed(), "w");
+    stub_advance(VIM_PENDING_REPEAT_TERM);
+    CHECK_STR(stub_typed(), "w2w");
+    CHECK_INT(stub_deferred_in_use(), 0);
+
+    // Arrows without anything pending are left to auto-repeat.
+    start();
+    tap(KC_DOWN);
+    CHECK_INT(stub_report_count, 2);
+
+    // Leaving the layer flushes what is buffered, as keymap.c does from
+    // layer_state_set_user().
+    start();
+    tap(KC_KP_4);
+    tap(KC_C);
+    layer_off(NAV_LAYER);
+    vim_pending_flush();
+    CHECK_STR(stub_typed(), "4c");
+    tap(KC_KP_4);
+    CHECK_STR(stub_typed(), "4c[5C]");
+
+    // Another key flushes as typed.
+    start();
+    tap(KC_KP_5);
+    tap(KC_X);
+    CHECK_STR(stub_typed(), "5x");
+
+    return stub_finish("vim_pending");
+}
@@ -0,0 +1,91 @@
+// Generated by make_text_expansion_data.py from text_expansion_dict.txt, do not edit.
+#pragma once
+
+// :teh:            -> the
+// :hte:            -> the
+// :adn:            -> and
+// :nad:            -> and
+// :taht:           -> that
+// :wiht:           -> with
+// :tihs:           -> this
+// :yuo:            -> you
+// :jsut:           -> just
+// :aslo:           -> also
+// :wich:           -> which
+// :whcih           -> which
+// :thier           -> their
+// :thign           -> thing
+// :becuase         -> because
+// :beacuse         -> because
+// :recieve         -> receive
+// :acheiv          -> achiev
+// :occured         -> occurred
+// :seperat         -> separat
+// :definat         -> definit
+// :untill:         -> until
+// :probelm         -> problem
+// :lenght          -> length
+// :widht           -> width
+// :heigth          -> height
+// :funciton        -> function
+// :fucntion        -> function
+// :retrun          -> return
+// :reutrn          -> return
+// :paramter        -> parameter
+// :cosnt:          -> const
+// :stirng          -> string
+// :nubmer          -> number
+// :ture:           -> true
+// :flase:          -> false
+// :btw:            -> by the way
+// :afaik:          -> as far as I know
+// :imo:            -> in my opinion
+
+#define TEXT_EXPANSION_MIN_LENGTH 5
+#define TEXT_EXPANSION_MAX_LENGTH 9
+#define TEXT_EXPANSION_DATA_SIZE 661
+
+static const uint8_t text_expansion_data[TEXT_EXPANSION_DATA_SIZE] PROGMEM = {
+    0x47, 0x29, 0x00, 0x00, 0x48, 0x36, 0x00, 0x00, 0x4A, 0x6E, 0x00, 0x00, 0x4B, 0x7B, 0x00, 0x00,
+    0x50, 0x98, 0x00, 0x00, 0x51, 0xA5, 0x00, 0x00, 0x55, 0xFB, 0x00, 0x00, 0x57, 0x2B, 0x01, 0x00,
+    0x59, 0x6D, 0x01, 0x00, 0x6C, 0x79, 0x01, 0x00, 0x00, 0x08, 0x15, 0x18, 0x06, 0x06, 0x12, 0x2C,
+    0x00, 0x81, 0x72, 0x65, 0x64, 0x00, 0x56, 0x3F, 0x00, 0x00, 0x59, 0x61, 0x00, 0x00, 0x00, 0x44,
+    0x48, 0x00, 0x00, 0x58, 0x54, 0x00, 0x00, 0x00, 0x18, 0x06, 0x08, 0x05, 0x2C, 0x00, 0x83, 0x61,
+    0x75, 0x73, 0x65, 0x00, 0x06, 0x04, 0x08, 0x05, 0x2C, 0x00, 0x84, 0x63, 0x61, 0x75, 0x73, 0x65,
+    0x00, 0x08, 0x0C, 0x06, 0x08, 0x15, 0x2C, 0x00, 0x83, 0x65, 0x69, 0x76, 0x65, 0x00, 0x11, 0x15,
+    0x0C, 0x17, 0x16, 0x2C, 0x00, 0x83, 0x72, 0x69, 0x6E, 0x67, 0x00, 0x4C, 0x84, 0x00, 0x00, 0x57,
+    0x8E, 0x00, 0x00, 0x00, 0x06, 0x0B, 0x1A, 0x2C, 0x00, 0x82, 0x69, 0x63, 0x68, 0x00, 0x0A, 0x0C,
+    0x08, 0x0B, 0x2C, 0x00, 0x81, 0x68, 0x74, 0x00, 0x0F, 0x08, 0x05, 0x12, 0x15, 0x13, 0x2C, 0x00,
+    0x82, 0x6C, 0x65, 0x6D, 0x00, 0x4A, 0xB6, 0x00, 0x00, 0x52, 0xBF, 0x00, 0x00, 0x55, 0xE4, 0x00,
+    0x00, 0x58, 0xF0, 0x00, 0x00, 0x00, 0x0C, 0x0B, 0x17, 0x2C, 0x00, 0x81, 0x6E, 0x67, 0x00, 0x4C,
+    0xC8, 0x00, 0x00, 0x57, 0xD7, 0x00, 0x00, 0x00, 0x17, 0x11, 0x06, 0x18, 0x09, 0x2C, 0x00, 0x85,
+    0x6E, 0x63, 0x74, 0x69, 0x6F, 0x6E, 0x00, 0x0C, 0x06, 0x11, 0x18, 0x09, 0x2C, 0x00, 0x83, 0x74,
+    0x69, 0x6F, 0x6E, 0x00, 0x17, 0x18, 0x08, 0x15, 0x2C, 0x00, 0x83, 0x74, 0x75, 0x72, 0x6E, 0x00,
+    0x15, 0x17, 0x08, 0x15, 0x2C, 0x00, 0x82, 0x75, 0x72, 0x6E, 0x00, 0x08, 0x00, 0x4C, 0x0A, 0x01,
+    0x00, 0x50, 0x13, 0x01, 0x00, 0x57, 0x1E, 0x01, 0x00, 0x00, 0x0B, 0x17, 0x2C, 0x00, 0x82, 0x65,
+    0x69, 0x72, 0x00, 0x05, 0x18, 0x11, 0x2C, 0x00, 0x83, 0x6D, 0x62, 0x65, 0x72, 0x00, 0x10, 0x04,
+    0x15, 0x04, 0x13, 0x2C, 0x00, 0x82, 0x65, 0x74, 0x65, 0x72, 0x00, 0x44, 0x34, 0x01, 0x00, 0x4B,
+    0x53, 0x01, 0x00, 0x00, 0x51, 0x3D, 0x01, 0x00, 0x55, 0x47, 0x01, 0x00, 0x00, 0x0C, 0x09, 0x08,
+    0x07, 0x2C, 0x00, 0x81, 0x69, 0x74, 0x00, 0x08, 0x13, 0x08, 0x16, 0x2C, 0x00, 0x83, 0x61, 0x72,
+    0x61, 0x74, 0x00, 0x47, 0x5C, 0x01, 0x00, 0x4A, 0x64, 0x01, 0x00, 0x00, 0x0C, 0x1A, 0x2C, 0x00,
+    0x81, 0x74, 0x68, 0x00, 0x11, 0x08, 0x0F, 0x2C, 0x00, 0x81, 0x74, 0x68, 0x00, 0x0C, 0x08, 0x0B,
+    0x06, 0x04, 0x2C, 0x00, 0x82, 0x69, 0x65, 0x76, 0x00, 0x47, 0xA2, 0x01, 0x00, 0x48, 0xAB, 0x01,
+    0x00, 0x4B, 0xD4, 0x01, 0x00, 0x4E, 0xEE, 0x01, 0x00, 0x4F, 0x05, 0x02, 0x00, 0x51, 0x0E, 0x02,
+    0x00, 0x52, 0x16, 0x02, 0x00, 0x56, 0x44, 0x02, 0x00, 0x57, 0x4E, 0x02, 0x00, 0x5A, 0x86, 0x02,
+    0x00, 0x00, 0x04, 0x11, 0x2C, 0x00, 0xC3, 0x61, 0x6E, 0x64, 0x00, 0x55, 0xB8, 0x01, 0x00, 0x56,
+    0xC1, 0x01, 0x00, 0x57, 0xCC, 0x01, 0x00, 0x00, 0x18, 0x17, 0x2C, 0x00, 0xC3, 0x72, 0x75, 0x65,
+    0x00, 0x04, 0x0F, 0x09, 0x2C, 0x00, 0xC4, 0x61, 0x6C, 0x73, 0x65, 0x00, 0x0B, 0x2C, 0x00, 0xC3,
+    0x74, 0x68, 0x65, 0x00, 0x46, 0xDD, 0x01, 0x00, 0x48, 0xE7, 0x01, 0x00, 0x00, 0x0C, 0x1A, 0x2C,
+    0x00, 0xC3, 0x68, 0x69, 0x63, 0x68, 0x00, 0x17, 0x2C, 0x00, 0xC2, 0x68, 0x65, 0x00, 0x0C, 0x04,
+    0x09, 0x04, 0x2C, 0x00, 0xC4, 0x73, 0x20, 0x66, 0x61, 0x72, 0x20, 0x61, 0x73, 0x20, 0x49, 0x20,
+    0x6B, 0x6E, 0x6F, 0x77, 0x00, 0x0F, 0x0C, 0x17, 0x11, 0x18, 0x2C, 0x00, 0xC1, 0x00, 0x07, 0x04,
+    0x2C, 0x00, 0xC2, 0x6E, 0x64, 0x00, 0x4F, 0x23, 0x02, 0x00, 0x50, 0x2C, 0x02, 0x00, 0x58, 0x3D,
+    0x02, 0x00, 0x00, 0x16, 0x04, 0x2C, 0x00, 0xC3, 0x6C, 0x73, 0x6F, 0x00, 0x0C, 0x2C, 0x00, 0xC2,
+    0x6E, 0x20, 0x6D, 0x79, 0x20, 0x6F, 0x70, 0x69, 0x6E, 0x69, 0x6F, 0x6E, 0x00, 0x1C, 0x2C, 0x00,
+    0xC2, 0x6F, 0x75, 0x00, 0x0B, 0x0C, 0x17, 0x2C, 0x00, 0xC3, 0x68, 0x69, 0x73, 0x00, 0x4B, 0x5B,
+    0x02, 0x00, 0x51, 0x73, 0x02, 0x00, 0x58, 0x7D, 0x02, 0x00, 0x00, 0x44, 0x64, 0x02, 0x00, 0x4C,
+    0x6C, 0x02, 0x00, 0x00, 0x17, 0x2C, 0x00, 0xC3, 0x68, 0x61, 0x74, 0x00, 0x1A, 0x2C, 0x00, 0xC2,
+    0x74, 0x68, 0x00, 0x16, 0x12, 0x06, 0x2C, 0x00, 0xC3, 0x6E, 0x73, 0x74, 0x00, 0x16, 0x0D, 0x2C,
+    0x00, 0xC3, 0x75, 0x73, 0x74, 0x00, 0x17, 0x05, 0x2C, 0x00, 0xC2, 0x79, 0x20, 0x74, 0x68, 0x65,
+    0x20, 0x77, 0x61, 0x79, 0x00,
+};